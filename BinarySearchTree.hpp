@@ -1,572 +1,1237 @@
-#ifndef BINARY_SEARCH_TREE_HPP
-#define BINARY_SEARCH_TREE_HPP
-
-#include <cassert>  //assert
-#include <iostream> //ostream
-#include <functional> //less
-
-// You may add aditional libraries here if needed. You may use any
-// part of the STL except for containers.
-
-template <typename T, typename Compare = std::less<T>>
-class BinarySearchTree {
-
-  // OVERVIEW: This class represents a binary search tree, storing
-  // elements of type T. The Compare functor determines the ordering
-  // between elements. The default is std::less<T>, which orders
-  // according to the < operator on T. (For simplicity, we assume only
-  // comparators that can be default constructed will be used.)
-
-  // INVARIANTS: All these invariants must hold for valid implementations
-  // of BinarySearchTree. The invariants may also be considered as an implicit
-  // part of the REQUIRES clause for all member functions - your implementations
-  // of those functions may assume the invariants hold and depend on them. Your
-  // implementations of member functions must also ensure the invariants hold
-  // when they have finished executing.
-  //
-  // INVARIANT: NO DUPLICATES
-  // The BST is not allowed to contain duplicate elements.
-  //
-  // INVARIANT: SORTING
-  // Consider a pointer to a node in the tree structure. It must obey
-  // the following sorting invariant:
-  // Either:
-  //   1) it is null (i.e. representing an empty part of the tree)
-  // OR
-  //   2) the node's left subtree obeys the sorting invariant, and every
-  //      element in the left subtree is strictly less than the datum
-  //      in the node
-  //      -- AND --
-  //      the node's right subtree obeys the sorting invariant, and every
-  //      element in the right subtree is strictly greater than the datum
-  //      in the node
-  // Again, "less than" and "greater than" are as defined by the
-  // Compare functor. Note that "greater than or equal to" and
-  // "greater than" end up meaning the same thing when duplicates are
-  // not allowed.
-
-  // NOTE: Any operation you define must use RECURSION rather than iteration.
-  //       You may NOT use any looping constructs.
-
-private:
-  struct Node {
-
-    // Default constructor - does nothing
-    Node() {}
-
-    // Custom constructor provided for convenience
-    Node(const T &datum_in, Node *left_in, Node *right_in)
-            : datum(datum_in), left(left_in), right(right_in) { }
-
-    T datum;
-    Node *left;
-    Node *right;
-  };
-
-public:
-
-  // Default constructor
-  // (Note this will default construct the less comparator)
-  BinarySearchTree()
-    : root(nullptr) { }
-
-  // Copy constructor
-  BinarySearchTree(const BinarySearchTree &other)
-    : root(copy_nodes_impl(other.root)) { }
-
-  // Assignment operator
-  BinarySearchTree &operator=(const BinarySearchTree &rhs) {
-    if (this == &rhs) {
-      return *this;
-    }
-    destroy_nodes_impl(root);
-    root = copy_nodes_impl(rhs.root);
-    return *this;
-  }
-
-  // Destructor
-  ~BinarySearchTree() {
-    destroy_nodes_impl(root);
-  }
-
-  // EFFECTS: Returns whether this BinarySearchTree is empty.
-  bool empty() const {
-    return empty_impl(root);
-  }
-
-  // EFFECTS: Returns the height of the tree.
-  size_t height() const {
-    return static_cast<size_t>(height_impl(root));
-  }
-
-  // EFFECTS: Returns the number of elements in this BinarySearchTree.
-  size_t size() const {
-    return static_cast<size_t>(size_impl(root));
-  }
-
-  // EFFECTS: Traverses the tree using an in-order traversal,
-  //          printing each element to os in turn. Each element is followed
-  //          by a space (there will be an "extra" space at the end).
-  //          If the tree is empty, nothing is printed.
-  void traverse_inorder(std::ostream &os) const {
-    traverse_inorder_impl(root, os);
-  }
-
-  // EFFECTS: Traverses the tree using a pre-order traversal,
-  //          printing each element to os in turn. Each element is followed
-  //          by a space (there will be an "extra" space at the end).
-  //          If the tree is empty, nothing is printed.
-  void traverse_preorder(std::ostream &os) const {
-    traverse_preorder_impl(root, os);
-  }
-
-  // EFFECTS: Returns whether or not the sorting invariant holds on
-  //          the root of this BinarySearchTree.
-  //
-  // NOTE: This function must be recursive.
-  bool check_sorting_invariant() const {
-    return check_sorting_invariant_impl(root, less);
-  }
-
-  class Iterator {
-    // OVERVIEW: Iterator interface for BinarySearchTree.
-    //           Iterates over the elements in ascending order as defined
-    //           by the sorted ordering of the BinarySearchTree.
-
-    // Big Three for Iterator not needed
-
-  public:
-    Iterator()
-      : root(nullptr), current_node(nullptr) {}
-
-    // EFFECTS:  Returns the current element by reference.
-    // WARNING:  Dereferencing an iterator returns an element from the tree
-    //           by reference, which could be modified. It is the
-    //           responsibility of the user to ensure that any
-    //           modifications result in a new value that compares equal
-    //           to the existing value. Otherwise, the sorting invariant
-    //           will no longer hold.
-    T &operator*() const {
-      return current_node->datum;
-    }
-
-    // EFFECTS:  Returns the current element by pointer.
-    // WARNING:  Dereferencing an iterator returns an element from the tree
-    //           by reference, which could be modified. It is the
-    //           responsibility of the user to ensure that any
-    //           modifications result in a new value that compares equal
-    //           to the existing value. Otherwise, the sorting invariant
-    //           will no longer hold.
-    // NOTE:     This allows the -> operator to be applied to an iterator
-    //           to access a member of the pointed-to element:
-    //             BinarySearchTree<std::pair<int, double>> tree;
-    //             auto it = tree.insert({ 3, 4.1 });
-    //             cout << it->first << endl; // prints 3
-    //             cout << it->second << endl; // prints 4.1
-    T *operator->() const {
-      return &current_node->datum;
-    }
-
-    // Prefix ++
-    Iterator &operator++() {
-      if (current_node->right) {
-        // If has right child, next element is minimum of right subtree
-        current_node = min_element_impl(current_node->right);
-      }
-      else {
-        // Otherwise, look in the whole tree for the next biggest element
-        current_node = min_greater_than_impl(root, current_node->datum, less);
-      }
-      return *this;
-    }
-
-    // Postfix ++ (implemented in terms of prefix ++)
-    Iterator operator++(int) {
-      Iterator result(*this);
-      ++(*this);
-      return result;
-    }
-
-    bool operator==(const Iterator &rhs) const {
-      return current_node == rhs.current_node;
-    }
-
-    bool operator!=(const Iterator &rhs) const {
-      return current_node != rhs.current_node;
-    }
-
-  private:
-    friend class BinarySearchTree;
-
-    Node *root;
-    Node *current_node;
-    Compare less;
-
-    Iterator(Node *root_in, Node* current_node_in, Compare less_in)
-      : root(root_in), current_node(current_node_in), less(less_in) { }
-
-  }; // BinarySearchTree::Iterator
-  ////////////////////////////////////////
-
-
-  // EFFECTS : Returns an iterator to the first element
-  //           in this BinarySearchTree.
-  Iterator begin() const {
-    if (root == nullptr) {
-      return Iterator();
-    }
-    return Iterator(root, min_element_impl(root), less);
-  }
-
-  // EFFECTS: Returns an iterator to past-the-end.
-  Iterator end() const {
-    return Iterator();
-  }
-
-
-  // EFFECTS: Returns an Iterator to the minimum element in this
-  //          BinarySearchTree or an end Iterator if the tree is empty.
-  Iterator min_element() const {
-    return Iterator(root, min_element_impl(root), less);
-  }
-
-  // EFFECTS: Returns an Iterator to the maximum element in this
-  //          BinarySearchTree or an end Iterator if the tree is empty.
-  Iterator max_element() const {
-    return Iterator(root, max_element_impl(root), less);
-  }
-
-  // EFFECTS: Returns an Iterator to the minimum element in this
-  //          BinarySearchTree greater than the given value.
-  //          If the tree is empty, returns an end Iterator.
-  Iterator min_greater_than(const T &value) const {
-    return Iterator(root, min_greater_than_impl(root, value, less), less);
-  }
-
-
-  // EFFECTS: Searches this tree for an element equivalent to query.
-  //          Returns an iterator to the existing element if found,
-  //          and an end iterator otherwise.
-  // WARNING: This function returns an Iterator that allows an element
-  //          contained in this tree to be modified. It is the
-  //          responsibility of the user to ensure that any
-  //          modifications result in a new value that compares equal
-  //          to the existing value. Otherwise, the sorting invariant
-  //          will no longer hold.
-  Iterator find(const T &query) const {
-    return Iterator(root, find_impl(root, query, less), less);
-  }
-
-  // REQUIRES: The given item is not already contained in this BinarySearchTree
-  // MODIFIES: this BinarySearchTree
-  // EFFECTS : Inserts the element k into this BinarySearchTree, maintaining
-  //           the sorting invariant.
-  Iterator insert(const T &item) {
-    assert(find(item) == end());
-    root = insert_impl(root, item, less);
-    return find(item);
-  }
-
-  // EFFECTS: Returns a human-readable string representation of this
-  //          BinarySearchTree. Works best for small trees.
-  //
-  // NOTE: This member function is implemented for you in TreePrint.hpp.
-  //       You may use it, but you don't need to worry about how it works.
-  std::string to_string() const;
-
-
-private:
-  Node *root;
-  Compare less;
-    
-  // NOTE: These member types are implemented for you in TreePrint.hpp.
-  //       They support the to_string function. You do not have to do
-  //       anything with them. DO NOT CHANGE.
-  class Tree_grid_square;
-  class Tree_grid;
-
-  // NOTE: This member function is implemented for you in TreePrint.hpp.
-  //       It supports the to_string function. You do not have to do
-  //       anything with it. DO NOT CHANGE.
-  int get_max_elt_width() const;
-
-
-
-// ---------- DO NOT CHANGE ANYTHING IN THIS FILE ABOVE THIS LINE ----------
-
-
-  // TREE IMPLEMENTATION FUNCTIONS
-  // You must write an implementation for each of these static member
-  // functions, which are called from the regular member functions that
-  // are included in the starter code for the BinarySearchTree class.
-
-
-  // EFFECTS: Returns whether the tree rooted at 'node' is empty.
-  // NOTE:    This function must run in constant time.
-  //          No iteration or recursion is allowed.
-  static bool empty_impl(const Node *node) {
-    return node == nullptr;
-  }
-
-  // EFFECTS: Returns the size of the tree rooted at 'node', which is the
-  //          total number of nodes in that tree. The size of an empty
-  //          tree is 0.
-  // NOTE:    This function must be tree recursive.
-  static int size_impl(const Node *node) {
-    if (!node) {
-      return 0;
-    } else {
-      return 1 + size_impl(node->left) + size_impl(node->right);
-    }
-  }
-
-  // EFFECTS: Returns the height of the tree rooted at 'node', which is the
-  //          number of nodes in the longest path from the 'node' to a leaf.
-  //          The height of an empty tree is 0.
-  // NOTE:    This function must be tree recursive.
-  static int height_impl(const Node *node) {
-    if (!node) {
-      return 0;
-    } else {
-      return 1 + std::max(height_impl(node->left), height_impl(node->right));
-    }
-  }
-
-  // EFFECTS: Creates and returns a pointer to the root of a new node structure
-  //          with the same elements and EXACTLY the same structure as the
-  //          tree rooted at 'node'.
-  // NOTE:    This function must be tree recursive.
-  static Node *copy_nodes_impl(Node *node) {
-    if (!node) {
-      return nullptr;
-    } else {
-      Node *new_node = new Node{ node->datum, 
-                                 copy_nodes_impl(node->left), 
-                                 copy_nodes_impl(node->right) };
-      return new_node;
-    }
-  }
-
-  // EFFECTS: Frees the memory for all nodes used in the tree rooted at 'node'.
-  // NOTE:    This function must be tree recursive.
-  static void destroy_nodes_impl(Node *node) {
-    if (!node) {
-      return;
-    } else {
-      destroy_nodes_impl(node->left);
-      destroy_nodes_impl(node->right);
-    }
-
-    delete node;
-  }
-
-  // EFFECTS : Searches the tree rooted at 'node' for an element equivalent
-  //           to 'query'. If one is found, returns a pointer to the node
-  //           containing it. If the tree is empty or the element is not
-  //           found, returns a null pointer.
-  //
-  // NOTE: This function must be tail recursive.
-  // HINT: Equivalence is defined according to the Compare functor
-  //       associated with this instantiation of the BinarySearchTree
-  //       template, NOT according to the == operator. Use the "less"
-  //       parameter to compare elements.
-  //       Two elements A and B are equivalent if and only if A is
-  //       not less than B and B is not less than A.
-  static Node * find_impl(Node *node, const T &query, Compare less) {
-    if (!node) {
-      return nullptr;
-    } 
-    else if (!less(node->datum, query) && !less(query, node->datum)) {
-      return node;
-    } 
-    else if (less(query, node->datum)){
-      return find_impl(node->left, query, less);
-    }
-    else {
-      return find_impl(node->right, query, less);
-    }
-  }
-
-  // REQUIRES: item is not already contained in the tree rooted at 'node'
-  // MODIFIES: the tree rooted at 'node'
-  // EFFECTS : If 'node' represents an empty tree, allocates a new
-  //           Node to represent a single-element tree with 'item' as
-  //           its only element and returns a pointer to the new Node.
-  //           If the tree rooted at 'node' is not empty, inserts
-  //           'item' into the proper location as a leaf in the
-  //           existing tree structure according to the sorting
-  //           invariant and returns the original parameter 'node'.
-  // NOTE: This function must be linear recursive, but does not
-  //       need to be tail recursive.
-  // HINT: Element ordering is defined according to the Compare functor
-  //       associated with this instantiation of the BinarySearchTree
-  //       template, NOT according to the < operator. Use the "less"
-  //       parameter to compare elements.
-  static Node * insert_impl(Node *node, const T &item, Compare less) {
-    if (!node) {
-      Node *new_node = new Node{item, nullptr, nullptr};
-      return new_node;
-    }
-    else if (less(item, node->datum)){
-      node->left = insert_impl(node->left, item, less);
-    }
-    else if (less(node->datum, item)) {
-      node->right = insert_impl(node->right, item, less);
-    }
-
-    return node;
-  }
-
-  // EFFECTS : Returns a pointer to the Node containing the minimum element
-  //           in the tree rooted at 'node' or a null pointer if the tree is empty.
-  // NOTE: This function must be tail recursive.
-  // NOTE: This function is used in the implementation of the ++ operator for
-  //       the iterator code that is provided for you.
-  // HINT: You don't need to compare any elements! Think about the
-  //       structure, and where the smallest element lives.
-  static Node * min_element_impl(Node *node) {
-    if (!node) {
-      return nullptr;
-    } 
-    else if (!min_element_impl(node->left)) {
-      return node;
-    } else {
-      return min_element_impl(node->left);
-    }
-  }
-
-  // EFFECTS : Returns a pointer to the Node containing the maximum element
-  //           in the tree rooted at 'node' or a null pointer if the tree is empty.
-  // NOTE: This function must be tail recursive.
-  // HINT: You don't need to compare any elements! Think about the
-  //       structure, and where the largest element lives.
-  static Node * max_element_impl(Node *node) {
-    if (!node) {
-      return nullptr;
-    } 
-    else if (!max_element_impl(node->right)) {
-      return node;
-    } else {
-      return max_element_impl(node->right);
-    }
-  }
-
-
-  // EFFECTS: Returns whether the sorting invariant holds on the tree
-  //          rooted at 'node'.
-  // NOTE:    This function must be tree recursive.
-  static bool check_sorting_invariant_impl(const Node *node, Compare less) {
-    if (!node) {
-      return true;
-    }
-    
-    bool sorted = check_sorting_invariant_impl(node->left, less)
-                  && check_sorting_invariant_impl(node->right, less);
-
-    bool left_less, right_greater;
-    left_less = right_greater = true;
-    if (node->left) {
-      left_less = less(node->left->datum, node->datum);
-    }
-    if (node->right) {
-      right_greater = less(node->datum, node->right->datum);
-    }
-
-    return sorted && left_less && right_greater;
-  }
-
-  // EFFECTS : Traverses the tree rooted at 'node' using an in-order traversal,
-  //           printing each element to os in turn. Each element is followed
-  //           by a space (there will be an "extra" space at the end).
-  //           If the tree is empty, nothing is printed.
-  // NOTE: This function must be tree recursive.
-  //       See https://en.wikipedia.org/wiki/Tree_traversal#In-order
-  //       for the definition of a in-order traversal.
-  static void traverse_inorder_impl(const Node *node, std::ostream &os) {
-    if (!node) {
-      return;
-    } else {
-      traverse_inorder_impl(node->left, os);
-      os << node->datum << " ";
-      traverse_inorder_impl(node->right, os);
-    }
-  }
-
-  // EFFECTS : Traverses the tree rooted at 'node' using a pre-order traversal,
-  //           printing each element to os in turn. Each element is followed
-  //           by a space (there will be an "extra" space at the end).
-  //           If the tree is empty, nothing is printed.
-  // NOTE: This function must be tree recursive.
-  //       See https://en.wikipedia.org/wiki/Tree_traversal#Pre-order
-  //       for the definition of a pre-order traversal.
-  static void traverse_preorder_impl(const Node *node, std::ostream &os) {
-    if (!node) {
-      return;
-    } else {
-      os << node->datum << " ";
-      traverse_preorder_impl(node->left, os);
-      traverse_preorder_impl(node->right, os);
-    }
-  }
-
-  // EFFECTS : Returns a pointer to the Node containing the smallest element
-  //           in the tree rooted at 'node' that is greater than 'val'.
-  //           Returns a null pointer if the tree is empty or if it does not
-  //           contain any elements that are greater than 'val'.
-  //
-  // NOTE: This function must be linear recursive.
-  // NOTE: This function is used in the implementation of the ++ operator for
-  //       the iterator code that is provided for you.
-  // HINT: At each step, compare 'val' the the current node (using the
-  //       'less' parameter). Based on the result, you gain some information
-  //       about where the element you're looking for could be.
-  static Node * min_greater_than_impl(Node *node, const T &val, Compare less) {
-    Node *temp_node;
-
-    if (!node) {
-      return nullptr;
-    }
-    else if (less(val, node->datum)) {
-      temp_node = min_greater_than_impl(node->left, val, less);
-    }
-    else {
-      temp_node = min_greater_than_impl(node->right, val, less);
-    }
-
-    if (!temp_node && less(val, node->datum)) {
-      return node;
-    }
-
-    return temp_node;
-  }
-
-
-}; // END of BinarySearchTree class
-
-#include "TreePrint.hpp" // DO NOT REMOVE!!!
-
-// MODIFIES: os
-// EFFECTS : Prints the elements in the tree to the given ostream,
-//           separated by a space. The elements are printed using an
-//           in-order traversal, and an initial "[" and trailing "]"
-//           are printed before the first and after the last element.
-//           Does not print a newline. Returns os.
-// EXAMPLES: [ ]
-//           [ 5 ]
-//           [ 3 5 7 ]
-// NOTE:     The correct operation of this function depends on the
-//           BinarySearchTree Iterator, which in turn depends on some
-//           of the functions you must write.
-
-template <typename T, typename Compare>
-std::ostream &operator<<(std::ostream &os,
-                         const BinarySearchTree<T, Compare> &tree) {
-// DO NOT CHANGE THE IMPLEMENTATION OF THIS FUNCTION
-  os << "[ ";
-  for (T& elt : tree) {
-    os << elt << " ";
-  }
-  return os << "]";
-}
-
-#endif // DO NOT REMOVE!!
+#ifndef BINARY_SEARCH_TREE_HPP
+#define BINARY_SEARCH_TREE_HPP
+
+#include <algorithm> //max
+#include <cassert>  //assert
+#include <iostream> //ostream
+#include <functional> //less
+#include <utility>  //swap
+#include <vector>   //vector
+
+template <typename T, typename Compare = std::less<T>>
+class BinarySearchTree {
+
+  // OVERVIEW: This class represents a binary search tree, storing
+  // elements of type T. The Compare functor determines the ordering
+  // between elements. The default is std::less<T>, which orders
+  // according to the < operator on T. (For simplicity, we assume only
+  // comparators that can be default constructed will be used.)
+
+  // INVARIANTS: All these invariants must hold for valid implementations
+  // of BinarySearchTree. The invariants may also be considered as an implicit
+  // part of the REQUIRES clause for all member functions - your implementations
+  // of those functions may assume the invariants hold and depend on them. Your
+  // implementations of member functions must also ensure the invariants hold
+  // when they have finished executing.
+  //
+  // INVARIANT: NO DUPLICATES
+  // The BST is not allowed to contain duplicate elements.
+  //
+  // INVARIANT: SORTING
+  // Consider a pointer to a node in the tree structure. It must obey
+  // the following sorting invariant:
+  // Either:
+  //   1) it is null (i.e. representing an empty part of the tree)
+  // OR
+  //   2) the node's left subtree obeys the sorting invariant, and every
+  //      element in the left subtree is strictly less than the datum
+  //      in the node
+  //      -- AND --
+  //      the node's right subtree obeys the sorting invariant, and every
+  //      element in the right subtree is strictly greater than the datum
+  //      in the node
+  // Again, "less than" and "greater than" are as defined by the
+  // Compare functor. Note that "greater than or equal to" and
+  // "greater than" end up meaning the same thing when duplicates are
+  // not allowed.
+
+  // NOTE: Hinted insertion does not rebalance, so a tree can be as tall as
+  //       its size. Every operation is therefore iterative, or recurses
+  //       only to a depth bounded by its arguments, except height(), the
+  //       traversals and check_sorting_invariant(), which recurse once per
+  //       level and are meant for testing.
+
+private:
+  struct Node {
+
+    // Default constructor - does nothing
+    Node() {}
+
+    // Custom constructor provided for convenience
+    Node(const T &datum_in, Node *left_in, Node *right_in)
+            : datum(datum_in), left(left_in), right(right_in) { }
+
+    // Moves datum_in into the node instead of copying it
+    Node(T &&datum_in, Node *left_in, Node *right_in)
+            : datum(std::move(datum_in)), left(left_in), right(right_in) { }
+
+    T datum;
+    Node *left;
+    Node *right;
+  };
+
+public:
+
+  // Default constructor
+  // (Note this will default construct the less comparator)
+  BinarySearchTree()
+    : root(nullptr), min_node(nullptr), max_node(nullptr) { }
+
+  // Copy constructor
+  BinarySearchTree(const BinarySearchTree &other)
+    : root(copy_nodes_impl(other.root)) {
+    update_extremes();
+  }
+
+  // Move constructor
+  // (Takes the nodes of other, leaving it empty)
+  BinarySearchTree(BinarySearchTree &&other)
+    : root(nullptr), min_node(nullptr), max_node(nullptr) {
+    swap(other);
+  }
+
+  // Assignment operator
+  BinarySearchTree &operator=(const BinarySearchTree &rhs) {
+    if (this == &rhs) {
+      return *this;
+    }
+    destroy_nodes_impl(root);
+    root = copy_nodes_impl(rhs.root);
+    update_extremes();
+    return *this;
+  }
+
+  // Move assignment operator
+  // (Frees the nodes of this tree and takes those of rhs, leaving it empty)
+  BinarySearchTree &operator=(BinarySearchTree &&rhs) {
+    if (this == &rhs) {
+      return *this;
+    }
+    destroy_nodes_impl(root);
+    root = min_node = max_node = nullptr;
+    swap(rhs);
+    return *this;
+  }
+
+  // Destructor
+  ~BinarySearchTree() {
+    destroy_nodes_impl(root);
+  }
+
+  // EFFECTS: Returns whether this BinarySearchTree is empty.
+  bool empty() const {
+    return empty_impl(root);
+  }
+
+  // EFFECTS: Returns the height of the tree.
+  size_t height() const {
+    return static_cast<size_t>(height_impl(root));
+  }
+
+  // EFFECTS: Returns the number of elements in this BinarySearchTree.
+  size_t size() const {
+    return static_cast<size_t>(size_impl(root));
+  }
+
+  // EFFECTS: Traverses the tree using an in-order traversal,
+  //          printing each element to os in turn. Each element is followed
+  //          by a space (there will be an "extra" space at the end).
+  //          If the tree is empty, nothing is printed.
+  void traverse_inorder(std::ostream &os) const {
+    traverse_inorder_impl(root, os);
+  }
+
+  // EFFECTS: Traverses the tree using a pre-order traversal,
+  //          printing each element to os in turn. Each element is followed
+  //          by a space (there will be an "extra" space at the end).
+  //          If the tree is empty, nothing is printed.
+  void traverse_preorder(std::ostream &os) const {
+    traverse_preorder_impl(root, os);
+  }
+
+  // EFFECTS: Returns whether or not the sorting invariant holds on
+  //          the root of this BinarySearchTree.
+  //
+  // NOTE: This function must be recursive.
+  bool check_sorting_invariant() const {
+    return check_sorting_invariant_impl(root, less);
+  }
+
+  class Iterator {
+    // OVERVIEW: Iterator interface for BinarySearchTree.
+    //           Iterates over the elements in ascending order as defined
+    //           by the sorted ordering of the BinarySearchTree.
+
+    // Big Three for Iterator not needed
+
+  public:
+    Iterator()
+      : root(nullptr), current_node(nullptr) {}
+
+    // EFFECTS:  Returns the current element by reference.
+    // WARNING:  Dereferencing an iterator returns an element from the tree
+    //           by reference, which could be modified. It is the
+    //           responsibility of the user to ensure that any
+    //           modifications result in a new value that compares equal
+    //           to the existing value. Otherwise, the sorting invariant
+    //           will no longer hold.
+    T &operator*() const {
+      return current_node->datum;
+    }
+
+    // EFFECTS:  Returns the current element by pointer.
+    // WARNING:  Dereferencing an iterator returns an element from the tree
+    //           by reference, which could be modified. It is the
+    //           responsibility of the user to ensure that any
+    //           modifications result in a new value that compares equal
+    //           to the existing value. Otherwise, the sorting invariant
+    //           will no longer hold.
+    // NOTE:     This allows the -> operator to be applied to an iterator
+    //           to access a member of the pointed-to element:
+    //             BinarySearchTree<std::pair<int, double>> tree;
+    //             auto it = tree.insert({ 3, 4.1 });
+    //             cout << it->first << endl; // prints 3
+    //             cout << it->second << endl; // prints 4.1
+    T *operator->() const {
+      return &current_node->datum;
+    }
+
+    // Prefix ++
+    Iterator &operator++() {
+      if (current_node->right) {
+        // If has right child, next element is minimum of right subtree
+        current_node = min_element_impl(current_node->right);
+      }
+      else {
+        // Otherwise, look in the whole tree for the next biggest element
+        current_node = min_greater_than_impl(root, current_node->datum, less);
+      }
+      return *this;
+    }
+
+    // Postfix ++ (implemented in terms of prefix ++)
+    Iterator operator++(int) {
+      Iterator result(*this);
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const Iterator &rhs) const {
+      return current_node == rhs.current_node;
+    }
+
+    bool operator!=(const Iterator &rhs) const {
+      return current_node != rhs.current_node;
+    }
+
+  private:
+    friend class BinarySearchTree;
+
+    Node *root;
+    Node *current_node;
+    Compare less;
+
+    Iterator(Node *root_in, Node* current_node_in, Compare less_in)
+      : root(root_in), current_node(current_node_in), less(less_in) { }
+
+  }; // BinarySearchTree::Iterator
+  ////////////////////////////////////////
+
+
+  // EFFECTS : Returns an iterator to the first element
+  //           in this BinarySearchTree.
+  Iterator begin() const {
+    if (root == nullptr) {
+      return Iterator();
+    }
+    return Iterator(root, min_node, less);
+  }
+
+  // EFFECTS: Returns an iterator to past-the-end.
+  Iterator end() const {
+    return Iterator();
+  }
+
+
+  // EFFECTS: Returns an Iterator to the minimum element in this
+  //          BinarySearchTree or an end Iterator if the tree is empty.
+  Iterator min_element() const {
+    return Iterator(root, min_node, less);
+  }
+
+  // EFFECTS: Returns an Iterator to the maximum element in this
+  //          BinarySearchTree or an end Iterator if the tree is empty.
+  Iterator max_element() const {
+    return Iterator(root, max_node, less);
+  }
+
+  // EFFECTS: Returns an Iterator to the minimum element in this
+  //          BinarySearchTree greater than the given value.
+  //          If the tree is empty, returns an end Iterator.
+  Iterator min_greater_than(const T &value) const {
+    return Iterator(root, min_greater_than_impl(root, value, less), less);
+  }
+
+
+  // EFFECTS: Searches this tree for an element equivalent to query.
+  //          Returns an iterator to the existing element if found,
+  //          and an end iterator otherwise.
+  // WARNING: This function returns an Iterator that allows an element
+  //          contained in this tree to be modified. It is the
+  //          responsibility of the user to ensure that any
+  //          modifications result in a new value that compares equal
+  //          to the existing value. Otherwise, the sorting invariant
+  //          will no longer hold.
+  Iterator find(const T &query) const {
+    return Iterator(root, find_impl(root, query, less), less);
+  }
+
+  // REQUIRES: The given item is not already contained in this BinarySearchTree
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Inserts the element k into this BinarySearchTree, maintaining
+  //           the sorting invariant.
+  Iterator insert(const T &item) {
+    assert(find(item) == end());
+    return insert_node(new Node(item, nullptr, nullptr));
+  }
+
+  // REQUIRES: The given item is not already contained in this BinarySearchTree
+  // MODIFIES: this BinarySearchTree, item
+  // EFFECTS : Moves item into this BinarySearchTree instead of copying it,
+  //           maintaining the sorting invariant.
+  Iterator insert(T &&item) {
+    assert(find(item) == end());
+    return insert_node(new Node(std::move(item), nullptr, nullptr));
+  }
+
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Inserts item as close as possible to just before 'hint',
+  //           maintaining the sorting invariant, and returns an iterator
+  //           to it. If an equivalent element is already in the tree,
+  //           returns an iterator to that element instead.
+  //           Runs in constant time when item belongs immediately
+  //           before 'hint', which covers loading ascending keys with
+  //           end() as the hint and descending keys with the previously
+  //           returned iterator. Otherwise falls back to a search from
+  //           the root.
+  // NOTE:    Hinted insertion never rebalances, so bulk loading sorted
+  //          keys produces a tall tree. Call rebalance() afterwards.
+  Iterator insert(Iterator hint, const T &item) {
+    return insert_hinted(hint, item);
+  }
+
+  // MODIFIES: this BinarySearchTree, item
+  // EFFECTS : Same as above, but moves item into the tree instead of
+  //           copying it. item is left unchanged if an equivalent element
+  //           is already in the tree.
+  Iterator insert(Iterator hint, T &&item) {
+    return insert_hinted(hint, std::move(item));
+  }
+
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Rebuilds this BinarySearchTree with the same elements and
+  //           minimum height, in linear time.
+  void rebalance() {
+    // relink the ascending list as the descending one the build expects
+    Node *list = nullptr;
+    size_t count = 0;
+    Node *node = flatten_impl(root, nullptr);
+    while (node) {
+      Node *next = node->right;
+      node->right = nullptr;
+      node->left = list;
+      list = node;
+      node = next;
+      ++count;
+    }
+    root = build_from_descending_impl(list, count);
+    update_extremes();
+  }
+
+  // REQUIRES: combine(a, b) returns an element equivalent to a and b
+  // MODIFIES: this BinarySearchTree, other
+  // EFFECTS : Moves every element of other into this BinarySearchTree.
+  //           Where both trees contain equivalent elements, the element
+  //           kept is combine(element in this, element in other). other
+  //           is left empty. Walks both trees in order and rebuilds a
+  //           balanced tree in O(n + m), without copying any elements.
+  template <typename Combine>
+  void merge(BinarySearchTree &other, Combine combine) {
+    combine_trees(other, SET_UNION, combine);
+  }
+
+  // REQUIRES: combine(a, b) returns an element equivalent to a and b
+  // MODIFIES: this BinarySearchTree, other
+  // EFFECTS : Keeps only the elements of this BinarySearchTree that have
+  //           an equivalent element in other, replacing each with
+  //           combine(element in this, element in other). other is left
+  //           empty. Runs in O(n + m) and leaves this tree balanced.
+  template <typename Combine>
+  void intersect(BinarySearchTree &other, Combine combine) {
+    combine_trees(other, SET_INTERSECTION, combine);
+  }
+
+  // MODIFIES: this BinarySearchTree, other
+  // EFFECTS : Removes every element of this BinarySearchTree that has an
+  //           equivalent element in other. other is left empty. Runs in
+  //           O(n + m) and leaves this tree balanced.
+  void subtract(BinarySearchTree &other) {
+    combine_trees(other, SET_DIFFERENCE, [](const T &a, const T &) {
+      return a;
+    });
+  }
+
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Removes every element that is not less than 'key' from
+  //           this BinarySearchTree and returns them as a new tree.
+  //           Nodes are relinked rather than copied, so this runs in
+  //           time proportional to the height of the tree.
+  BinarySearchTree split(const T &key) {
+    Node *not_less = nullptr;
+    root = split_impl(root, key, not_less, less);
+    update_extremes();
+    return BinarySearchTree(not_less);
+  }
+
+  // REQUIRES: every element of left is less than every element of right
+  // MODIFIES: left, right
+  // EFFECTS : Returns a tree holding the elements of both left and right,
+  //           leaving them empty. Nodes are relinked rather than copied,
+  //           so this runs in time proportional to the height of left.
+  static BinarySearchTree join(BinarySearchTree &left,
+                               BinarySearchTree &right) {
+    assert(left.empty() || right.empty()
+           || left.less(*left.max_element(), *right.min_element()));
+    Node *joined = join_impl(left.root, right.root);
+    left.root = nullptr;
+    right.root = nullptr;
+    left.update_extremes();
+    right.update_extremes();
+    return BinarySearchTree(joined);
+  }
+
+  // MODIFIES: this BinarySearchTree, other
+  // EFFECTS : Exchanges the elements of this BinarySearchTree and other
+  //           in constant time.
+  void swap(BinarySearchTree &other) {
+    std::swap(root, other.root);
+    std::swap(min_node, other.min_node);
+    std::swap(max_node, other.max_node);
+  }
+
+  class Range {
+    // OVERVIEW: A contiguous run of elements of a BinarySearchTree, in
+    //           ascending order: either a whole subtree or a single
+    //           element. Produced by partition(). Different Ranges of the
+    //           same tree share no nodes, so they can be visited
+    //           concurrently.
+
+  public:
+    Range()
+      : node(nullptr), whole_subtree(false) { }
+
+    // EFFECTS:  Calls fn(element) for every element in this Range, in
+    //           ascending order.
+    // WARNING:  fn receives each element by reference. Any modification
+    //           must result in a new value that compares equal to the
+    //           existing value.
+    template <typename Function>
+    void for_each(Function &fn) const {
+      if (whole_subtree) {
+        for_each_impl(node, fn);
+      }
+      else if (node) {
+        fn(node->datum);
+      }
+    }
+
+  private:
+    friend class BinarySearchTree;
+
+    Node *node;
+    bool whole_subtree;
+
+    Range(Node *node_in, bool whole_subtree_in)
+      : node(node_in), whole_subtree(whole_subtree_in) { }
+
+  }; // BinarySearchTree::Range
+  ////////////////////////////////////////
+
+  // EFFECTS : Divides the elements of this BinarySearchTree into Ranges
+  //           and calls emit(range) for each, in ascending order. Whole
+  //           subtrees are split until there are about 'parts' Ranges of
+  //           roughly equal size; the roots of split subtrees become
+  //           single-element Ranges, so up to 2 * parts Ranges may be
+  //           emitted. Runs in O(n log parts).
+  template <typename Emit>
+  void partition(size_t parts, Emit emit) const {
+    partition_impl(root, size_impl(root), parts, emit);
+  }
+
+  class Node_handle {
+    // OVERVIEW: Owns a single element that has been extracted from a
+    //           BinarySearchTree, together with its node, so that it can
+    //           be inserted into another tree without any allocation or
+    //           copy. An empty handle owns nothing. Destroying a
+    //           non-empty handle frees the element.
+
+  public:
+    Node_handle()
+      : node(nullptr) { }
+
+    Node_handle(Node_handle &&other)
+      : node(other.node) {
+      other.node = nullptr;
+    }
+
+    Node_handle &operator=(Node_handle &&rhs) {
+      if (this != &rhs) {
+        delete node;
+        node = rhs.node;
+        rhs.node = nullptr;
+      }
+      return *this;
+    }
+
+    ~Node_handle() {
+      delete node;
+    }
+
+    // EFFECTS: Returns whether this handle owns no element.
+    bool empty() const {
+      return node == nullptr;
+    }
+
+    // REQUIRES: this handle is not empty
+    // EFFECTS:  Returns the owned element by reference. It may be modified
+    //           freely, since it is not part of any tree.
+    T &value() const {
+      assert(node);
+      return node->datum;
+    }
+
+  private:
+    friend class BinarySearchTree;
+
+    Node *node;
+
+    explicit Node_handle(Node *node_in)
+      : node(node_in) { }
+
+  }; // BinarySearchTree::Node_handle
+  ////////////////////////////////////////
+
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Removes the element equivalent to 'key' from this
+  //           BinarySearchTree and returns a handle that owns it, or an
+  //           empty handle if there is no such element. Runs in time
+  //           proportional to the height of the tree.
+  Node_handle extract(const T &key) {
+    Node *removed = nullptr;
+    root = remove_impl(root, key, removed, less);
+    update_extremes();
+    return Node_handle(removed);
+  }
+
+  // MODIFIES: this BinarySearchTree, handle
+  // EFFECTS : If handle is empty, returns an end Iterator. If an element
+  //           equivalent to the one owned by handle is already in this
+  //           BinarySearchTree, returns an Iterator to it and leaves
+  //           handle unchanged. Otherwise links the node owned by handle
+  //           into this tree without allocating, empties handle and
+  //           returns an Iterator to the inserted element.
+  Iterator insert(Node_handle &&handle) {
+    if (handle.empty()) {
+      return end();
+    }
+    Iterator existing = find(handle.value());
+    if (existing != end()) {
+      return existing;
+    }
+    Node *node = handle.node;
+    handle.node = nullptr;
+    return insert_node(node);
+  }
+
+  // EFFECTS: Returns a human-readable string representation of this
+  //          BinarySearchTree. Works best for small trees.
+  //
+  // NOTE: This member function is implemented for you in TreePrint.hpp.
+  //       You may use it, but you don't need to worry about how it works.
+  std::string to_string() const;
+
+
+private:
+  Node *root;
+  Compare less;
+
+  // Cached nodes holding the minimum and maximum elements, or null if
+  // the tree is empty. Every member function that changes the shape of
+  // the tree must call update_extremes() before returning.
+  Node *min_node;
+  Node *max_node;
+
+  // NOTE: These member types are implemented for you in TreePrint.hpp.
+  //       They support the to_string function. You do not have to do
+  //       anything with them. DO NOT CHANGE.
+  class Tree_grid_square;
+  class Tree_grid;
+
+  // NOTE: This member function is implemented for you in TreePrint.hpp.
+  //       It supports the to_string function. You do not have to do
+  //       anything with it. DO NOT CHANGE.
+  int get_max_elt_width() const;
+
+  // Takes ownership of the nodes rooted at 'root_in'
+  explicit BinarySearchTree(Node *root_in)
+    : root(root_in) {
+    update_extremes();
+  }
+
+  // REQUIRES: new_node is not linked into any tree, and its element is
+  //           not already contained in this BinarySearchTree
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Takes ownership of new_node and links it in as a leaf,
+  //           returning an Iterator to its element.
+  Iterator insert_node(Node *new_node) {
+    new_node->left = nullptr;
+    new_node->right = nullptr;
+    root = insert_impl(root, new_node, less);
+    update_extremes();
+    return Iterator(root, new_node, less);
+  }
+
+  // MODIFIES: this BinarySearchTree
+  // EFFECTS : Recomputes min_node and max_node from the current tree.
+  void update_extremes() {
+    min_node = min_element_impl(root);
+    max_node = max_element_impl(root);
+  }
+
+  // MODIFIES: this BinarySearchTree, item
+  // EFFECTS : Implements both hinted inserts, copying or moving item into
+  //           a new node as Item is an lvalue or rvalue reference.
+  template <typename Item>
+  Iterator insert_hinted(Iterator hint, Item &&item) {
+    Node *node = insert_before_impl(hint.current_node,
+                                    std::forward<Item>(item));
+    if (!node) {
+      node = find_impl(root, item, less);
+    }
+    if (!node) {
+      return insert_node(new Node(std::forward<Item>(item), nullptr, nullptr));
+    }
+    return Iterator(root, node, less);
+  }
+
+  // MODIFIES: this BinarySearchTree, item
+  // EFFECTS : If 'item' belongs immediately before 'hint' (or after the
+  //           maximum, if 'hint' is null) and that position can be
+  //           checked without searching from the root, links a new node
+  //           for 'item' there, copying or moving item into it, and
+  //           returns it. If 'item' is equivalent to one of the
+  //           neighbours examined, returns that node. Otherwise returns a
+  //           null pointer and leaves the tree and item unchanged.
+  template <typename Item>
+  Node * insert_before_impl(Node *hint, Item &&item) {
+    if (!root) {
+      return nullptr;
+    }
+    else if (!hint) {
+      // Appending after the maximum
+      if (less(max_node->datum, item)) {
+        max_node->right = new Node(std::forward<Item>(item), nullptr, nullptr);
+        max_node = max_node->right;
+        return max_node;
+      }
+      return equivalent(max_node->datum, item) ? max_node : nullptr;
+    }
+    else if (!less(item, hint->datum)) {
+      return equivalent(hint->datum, item) ? hint : nullptr;
+    }
+    else if (hint == min_node) {
+      // Prepending before the minimum
+      hint->left = new Node(std::forward<Item>(item), nullptr, nullptr);
+      min_node = hint->left;
+      return min_node;
+    }
+    else if (!hint->left) {
+      // The predecessor is an ancestor of 'hint', which we cannot reach
+      return nullptr;
+    }
+
+    Node *predecessor = max_element_impl(hint->left);
+    if (less(predecessor->datum, item)) {
+      predecessor->right = new Node(std::forward<Item>(item), nullptr, nullptr);
+      return predecessor->right;
+    }
+    return equivalent(predecessor->datum, item) ? predecessor : nullptr;
+  }
+
+  // EFFECTS : Returns whether a and b are equivalent under 'less'.
+  bool equivalent(const T &a, const T &b) const {
+    return !less(a, b) && !less(b, a);
+  }
+
+  // Which elements survive when two trees are combined by merge,
+  // intersect or subtract.
+  enum Set_operation { SET_UNION, SET_INTERSECTION, SET_DIFFERENCE };
+
+  // MODIFIES: this BinarySearchTree, other
+  // EFFECTS : Flattens both trees into sorted lists, merges the lists
+  //           according to 'op' and rebuilds this tree balanced from the
+  //           result. other is left empty.
+  template <typename Combine>
+  void combine_trees(BinarySearchTree &other, Set_operation op,
+                     Combine combine) {
+    if (this == &other) {
+      return;
+    }
+    Node *lhs = flatten_impl(root, nullptr);
+    Node *rhs = flatten_impl(other.root, nullptr);
+    root = nullptr;
+    other.root = nullptr;
+
+    size_t count = 0;
+    Node *merged = merge_lists_impl(lhs, rhs, nullptr, count,
+                                    op, combine, less);
+    root = build_from_descending_impl(merged, count);
+    update_extremes();
+    other.update_extremes();
+  }
+
+
+  // TREE IMPLEMENTATION FUNCTIONS
+  // Static helpers that work on the nodes of the tree rooted at 'node'.
+  // They are called from the member functions above.
+
+
+  // EFFECTS: Returns whether the tree rooted at 'node' is empty.
+  // NOTE:    This function must run in constant time.
+  //          No iteration or recursion is allowed.
+  static bool empty_impl(const Node *node) {
+    return node == nullptr;
+  }
+
+  // EFFECTS: Returns the size of the tree rooted at 'node', which is the
+  //          total number of nodes in that tree. The size of an empty
+  //          tree is 0.
+  // NOTE:    This function is iterative: it walks down left children,
+  //          keeping the right subtrees it has still to count on a stack.
+  static int size_impl(const Node *node) {
+    int size = 0;
+    std::vector<const Node *> pending(1, node);
+    while (!pending.empty()) {
+      const Node *next = pending.back();
+      pending.pop_back();
+      for (; next; next = next->left) {
+        ++size;
+        if (next->right) {
+          pending.push_back(next->right);
+        }
+      }
+    }
+    return size;
+  }
+
+  // EFFECTS: Returns the height of the tree rooted at 'node', which is the
+  //          number of nodes in the longest path from the 'node' to a leaf.
+  //          The height of an empty tree is 0.
+  // NOTE:    This function must be tree recursive.
+  static int height_impl(const Node *node) {
+    if (!node) {
+      return 0;
+    } else {
+      return 1 + std::max(height_impl(node->left), height_impl(node->right));
+    }
+  }
+
+  // EFFECTS: Creates and returns a pointer to the root of a new node structure
+  //          with the same elements and EXACTLY the same structure as the
+  //          tree rooted at 'node'.
+  // NOTE:    This function is iterative, in the same way as size_impl.
+  //          Each right subtree still to copy is kept on the stack with
+  //          the link in the new structure that it must be attached to.
+  static Node *copy_nodes_impl(Node *node) {
+    Node *copy = nullptr;
+    std::vector<std::pair<const Node *, Node **>> pending(1, { node, &copy });
+    while (!pending.empty()) {
+      const Node *next = pending.back().first;
+      Node **link = pending.back().second;
+      pending.pop_back();
+      for (; next; next = next->left) {
+        *link = new Node{ next->datum, nullptr, nullptr };
+        if (next->right) {
+          pending.push_back({ next->right, &(*link)->right });
+        }
+        link = &(*link)->left;
+      }
+    }
+    return copy;
+  }
+
+  // EFFECTS: Frees the memory for all nodes used in the tree rooted at 'node'.
+  // NOTE:    This function is iterative: flatten_impl relinks the nodes
+  //          into a list without using any stack, and the list is freed.
+  static void destroy_nodes_impl(Node *node) {
+    node = flatten_impl(node, nullptr);
+    while (node) {
+      Node *next = node->right;
+      delete node;
+      node = next;
+    }
+  }
+
+  // EFFECTS : Searches the tree rooted at 'node' for an element equivalent
+  //           to 'query'. If one is found, returns a pointer to the node
+  //           containing it. If the tree is empty or the element is not
+  //           found, returns a null pointer.
+  //
+  // NOTE: Equivalence is defined according to the Compare functor
+  //       associated with this instantiation of the BinarySearchTree
+  //       template, NOT according to the == operator.
+  //       Two elements A and B are equivalent if and only if A is
+  //       not less than B and B is not less than A.
+  static Node * find_impl(Node *node, const T &query, Compare less) {
+    while (node) {
+      if (less(query, node->datum)) {
+        node = node->left;
+      }
+      else if (less(node->datum, query)) {
+        node = node->right;
+      }
+      else {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  // REQUIRES: the element of 'new_node' is not already contained in the
+  //           tree rooted at 'node', and 'new_node' has no children
+  // MODIFIES: the tree rooted at 'node'
+  // EFFECTS : If 'node' represents an empty tree, returns 'new_node' as
+  //           a single-element tree. If the tree rooted at 'node' is not
+  //           empty, links 'new_node' into the proper location as a leaf
+  //           in the existing tree structure according to the sorting
+  //           invariant and returns the original parameter 'node'.
+  //           Taking an allocated node lets callers copy, move or reuse
+  //           the element as they see fit.
+  // NOTE: Element ordering is defined according to the Compare functor
+  //       associated with this instantiation of the BinarySearchTree
+  //       template, NOT according to the < operator.
+  static Node * insert_impl(Node *node, Node *new_node, Compare less) {
+    Node **link = &node;
+    while (*link) {
+      if (less(new_node->datum, (*link)->datum)) {
+        link = &(*link)->left;
+      }
+      else {
+        link = &(*link)->right;
+      }
+    }
+    *link = new_node;
+    return node;
+  }
+
+  // EFFECTS : Returns a pointer to the Node containing the minimum element
+  //           in the tree rooted at 'node' or a null pointer if the tree is empty.
+  // NOTE: This function is used in the implementation of the ++ operator
+  //       of the Iterator.
+  static Node * min_element_impl(Node *node) {
+    while (node && node->left) {
+      node = node->left;
+    }
+    return node;
+  }
+
+  // EFFECTS : Returns a pointer to the Node containing the maximum element
+  //           in the tree rooted at 'node' or a null pointer if the tree is empty.
+  static Node * max_element_impl(Node *node) {
+    while (node && node->right) {
+      node = node->right;
+    }
+    return node;
+  }
+
+
+  // EFFECTS: Returns whether the sorting invariant holds on the tree
+  //          rooted at 'node'.
+  // NOTE:    This function must be tree recursive.
+  static bool check_sorting_invariant_impl(const Node *node, Compare less) {
+    if (!node) {
+      return true;
+    }
+    
+    bool sorted = check_sorting_invariant_impl(node->left, less)
+                  && check_sorting_invariant_impl(node->right, less);
+
+    bool left_less, right_greater;
+    left_less = right_greater = true;
+    if (node->left) {
+      left_less = less(node->left->datum, node->datum);
+    }
+    if (node->right) {
+      right_greater = less(node->datum, node->right->datum);
+    }
+
+    return sorted && left_less && right_greater;
+  }
+
+  // EFFECTS : Traverses the tree rooted at 'node' using an in-order traversal,
+  //           printing each element to os in turn. Each element is followed
+  //           by a space (there will be an "extra" space at the end).
+  //           If the tree is empty, nothing is printed.
+  // NOTE: This function must be tree recursive.
+  //       See https://en.wikipedia.org/wiki/Tree_traversal#In-order
+  //       for the definition of a in-order traversal.
+  static void traverse_inorder_impl(const Node *node, std::ostream &os) {
+    if (!node) {
+      return;
+    } else {
+      traverse_inorder_impl(node->left, os);
+      os << node->datum << " ";
+      traverse_inorder_impl(node->right, os);
+    }
+  }
+
+  // EFFECTS : Traverses the tree rooted at 'node' using a pre-order traversal,
+  //           printing each element to os in turn. Each element is followed
+  //           by a space (there will be an "extra" space at the end).
+  //           If the tree is empty, nothing is printed.
+  // NOTE: This function must be tree recursive.
+  //       See https://en.wikipedia.org/wiki/Tree_traversal#Pre-order
+  //       for the definition of a pre-order traversal.
+  static void traverse_preorder_impl(const Node *node, std::ostream &os) {
+    if (!node) {
+      return;
+    } else {
+      os << node->datum << " ";
+      traverse_preorder_impl(node->left, os);
+      traverse_preorder_impl(node->right, os);
+    }
+  }
+
+  // EFFECTS : Returns a pointer to the Node containing the smallest element
+  //           in the tree rooted at 'node' that is greater than 'val'.
+  //           Returns a null pointer if the tree is empty or if it does not
+  //           contain any elements that are greater than 'val'.
+  //
+  // NOTE: This function is iterative, since the ++ operator of the
+  //       Iterator calls it from the root for every element that has no
+  //       right child. It remembers the last node greater than 'val' on
+  //       the way down, which is the answer once the walk falls off the tree.
+  static Node * min_greater_than_impl(Node *node, const T &val, Compare less) {
+    Node *candidate = nullptr;
+    while (node) {
+      if (less(val, node->datum)) {
+        candidate = node;
+        node = node->left;
+      }
+      else {
+        node = node->right;
+      }
+    }
+    return candidate;
+  }
+
+  // MODIFIES: the tree rooted at 'node'
+  // EFFECTS : Rearranges the tree rooted at 'node' into a list of its
+  //           nodes in ascending order, linked through their right
+  //           pointers (every left pointer is null), followed by the list
+  //           starting at 'tail'. Returns the head of the combined list.
+  // NOTE:    This function is iterative: walking down the right pointers,
+  //          it rotates right at every node that has a left child until
+  //          none is left, so a tree as tall as its size, such as one
+  //          bulk loaded by hinted insertion, needs no stack.
+  static Node * flatten_impl(Node *node, Node *tail) {
+    Node *head = node;
+    Node **link = &head;
+    while (*link) {
+      Node *top = *link;
+      if (top->left) {
+        Node *left = top->left;
+        top->left = left->right;
+        left->right = top;
+        *link = left;
+      }
+      else {
+        link = &top->right;
+      }
+    }
+    *link = tail;
+    return head;
+  }
+
+  // REQUIRES: 'lhs' and 'rhs' are ascending lists as produced by
+  //           flatten_impl, and 'out' is a descending list linked through
+  //           left pointers whose elements are all less than those
+  //           remaining in 'lhs' and 'rhs'.
+  // MODIFIES: every node in 'lhs', 'rhs' and 'out', count
+  // EFFECTS : Merges 'lhs' and 'rhs' onto the front of 'out', keeping
+  //           the elements selected by 'op' and deleting the rest.
+  //           Equivalent elements are collapsed into the 'lhs' node,
+  //           which receives combine(lhs element, rhs element). Adds the
+  //           number of kept nodes to count and returns the new head of
+  //           the descending list.
+  // NOTE:    This function is iterative, since a list may be far longer
+  //          than the stack is deep, and builds without optimization do
+  //          not turn tail calls into loops.
+  template <typename Combine>
+  static Node * merge_lists_impl(Node *lhs, Node *rhs, Node *out,
+                                 size_t &count, Set_operation op,
+                                 Combine &combine, Compare less) {
+    while (lhs || rhs) {
+      Node *kept = nullptr;
+      Node *dropped = nullptr;
+      if (!rhs || (lhs && less(lhs->datum, rhs->datum))) {
+        // lhs element has no equivalent in rhs
+        (op == SET_INTERSECTION ? dropped : kept) = lhs;
+        lhs = lhs->right;
+      }
+      else if (!lhs || less(rhs->datum, lhs->datum)) {
+        // rhs element has no equivalent in lhs
+        (op == SET_UNION ? kept : dropped) = rhs;
+        rhs = rhs->right;
+      }
+      else {
+        // Equivalent elements collapse into the lhs node
+        if (op != SET_DIFFERENCE) {
+          lhs->datum = combine(lhs->datum, rhs->datum);
+        }
+        (op == SET_DIFFERENCE ? dropped : kept) = lhs;
+        lhs = lhs->right;
+        Node *equivalent = rhs;
+        rhs = rhs->right;
+        delete equivalent;
+      }
+
+      if (dropped) {
+        delete dropped;
+      }
+      if (kept) {
+        kept->right = nullptr;
+        kept->left = out;
+        out = kept;
+        ++count;
+      }
+    }
+    return out;
+  }
+
+  // REQUIRES: 'list' is a descending list of 'n' nodes, linked through
+  //           left pointers
+  // MODIFIES: every node in 'list'
+  // EFFECTS : Builds a tree of minimum height from the nodes of 'list'
+  //           and returns its root.
+  // NOTE:    This function is iterative (the Day-Stout-Warren method):
+  //          the list is relinked into an ascending chain of right
+  //          children, which rounds of left rotations fold into a
+  //          balanced tree.
+  static Node * build_from_descending_impl(Node *list, size_t n) {
+    Node *root = nullptr;
+    while (list) {
+      Node *next = list->left;
+      list->left = nullptr;
+      list->right = root;
+      root = list;
+      list = next;
+    }
+    // the size of the largest complete tree that fits, 2^k - 1
+    size_t complete = 0;
+    while (complete * 2 + 1 <= n) {
+      complete = complete * 2 + 1;
+    }
+    // the nodes beyond it become the leaves of the bottom level
+    compress_impl(&root, n - complete);
+    for (size_t size = complete / 2; size > 0; size /= 2) {
+      compress_impl(&root, size);
+    }
+    return root;
+  }
+
+  // REQUIRES: the chain of right children from *link has at least
+  //           2 * count nodes
+  // MODIFIES: the nodes of that chain
+  // EFFECTS : Rotates left at every other node of the chain, count
+  //           times, so each rotated node becomes the left child of the
+  //           next node of the chain.
+  static void compress_impl(Node **link, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      Node *child = *link;
+      Node *grandchild = child->right;
+      child->right = grandchild->left;
+      grandchild->left = child;
+      *link = grandchild;
+      link = &grandchild->right;
+    }
+  }
+
+  // MODIFIES: the tree rooted at 'node', not_less
+  // EFFECTS : Splits the tree rooted at 'node' into the elements less
+  //           than 'key', whose root is returned, and the remaining
+  //           elements, whose root is stored in 'not_less'. Both results
+  //           obey the sorting invariant. No nodes are created or freed.
+  // NOTE:    Walking down from the root, each node keeps the subtree on
+  //          its own side of 'key' and is linked into the open link of
+  //          the result it belongs to, which then moves to its other child.
+  static Node * split_impl(Node *node, const T &key, Node *&not_less,
+                           Compare less) {
+    Node *lesser = nullptr;
+    Node **lesser_link = &lesser;
+    Node **not_less_link = &not_less;
+    while (node) {
+      if (less(node->datum, key)) {
+        *lesser_link = node;
+        lesser_link = &node->right;
+        node = node->right;
+      }
+      else {
+        *not_less_link = node;
+        not_less_link = &node->left;
+        node = node->left;
+      }
+    }
+    *lesser_link = nullptr;
+    *not_less_link = nullptr;
+    return lesser;
+  }
+
+  // REQUIRES: every element in the tree rooted at 'left' is less than
+  //           every element in the tree rooted at 'right'
+  // MODIFIES: the trees rooted at 'left' and 'right'
+  // EFFECTS : Returns the root of a tree containing the elements of both
+  //           trees. The maximum of 'left' becomes the new root, so the
+  //           result is at most one level taller than the taller input.
+  static Node * join_impl(Node *left, Node *right) {
+    if (!left) {
+      return right;
+    }
+    else if (!right) {
+      return left;
+    }
+    Node *max_node = nullptr;
+    Node *rest = remove_max_impl(left, max_node);
+    max_node->left = rest;
+    max_node->right = right;
+    return max_node;
+  }
+
+  // EFFECTS : Emits the tree rooted at 'node', which holds 'size'
+  //           elements, as about 'parts' Ranges in ascending order. The
+  //           parts are shared between the subtrees in proportion to
+  //           their sizes, each getting at least one. A subtree with an
+  //           empty side is emitted whole, so the recursion is at most
+  //           'parts' deep even on a tall tree.
+  template <typename Emit>
+  static void partition_impl(Node *node, size_t size, size_t parts,
+                             Emit &emit) {
+    if (!node) {
+      return;
+    }
+    else if (parts <= 1 || !node->left || !node->right) {
+      emit(Range(node, true));
+      return;
+    }
+    size_t left_size = static_cast<size_t>(size_impl(node->left));
+    size_t right_size = size - 1 - left_size;
+    size_t left_parts = (parts * left_size + size / 2) / size;
+    left_parts = std::min(std::max(left_parts, size_t(1)), parts - 1);
+    partition_impl(node->left, left_size, left_parts, emit);
+    emit(Range(node, false));
+    partition_impl(node->right, right_size, parts - left_parts, emit);
+  }
+
+  // EFFECTS : Calls fn(element) for every element in the tree rooted at
+  //           'node', using an in-order traversal.
+  // NOTE:    This function is iterative, keeping the nodes whose left
+  //          subtree is being visited on a stack.
+  template <typename Function>
+  static void for_each_impl(Node *node, Function &fn) {
+    std::vector<Node *> pending;
+    while (node || !pending.empty()) {
+      if (node) {
+        pending.push_back(node);
+        node = node->left;
+      }
+      else {
+        node = pending.back();
+        pending.pop_back();
+        fn(node->datum);
+        node = node->right;
+      }
+    }
+  }
+
+  // MODIFIES: the tree rooted at 'node', removed
+  // EFFECTS : Unlinks the node holding the element equivalent to 'key'
+  //           from the tree rooted at 'node', stores it in 'removed' with
+  //           no children and returns the root of the remaining tree.
+  //           If there is no such element, stores a null pointer.
+  static Node * remove_impl(Node *node, const T &key, Node *&removed,
+                            Compare less) {
+    Node **link = &node;
+    while (*link) {
+      if (less(key, (*link)->datum)) {
+        link = &(*link)->left;
+      }
+      else if (less((*link)->datum, key)) {
+        link = &(*link)->right;
+      }
+      else {
+        break;
+      }
+    }
+    removed = *link;
+    if (removed) {
+      *link = join_impl(removed->left, removed->right);
+      removed->left = nullptr;
+      removed->right = nullptr;
+    }
+    return node;
+  }
+
+  // REQUIRES: 'node' is not null
+  // MODIFIES: the tree rooted at 'node', max_node
+  // EFFECTS : Unlinks the node holding the maximum element of the tree
+  //           rooted at 'node', stores it in 'max_node' and returns the
+  //           root of the remaining tree.
+  static Node * remove_max_impl(Node *node, Node *&max_node) {
+    Node **link = &node;
+    while ((*link)->right) {
+      link = &(*link)->right;
+    }
+    max_node = *link;
+    *link = max_node->left;
+    return node;
+  }
+
+}; // END of BinarySearchTree class
+
+#include "TreePrint.hpp" // DO NOT REMOVE!!!
+
+// MODIFIES: os
+// EFFECTS : Prints the elements in the tree to the given ostream,
+//           separated by a space. The elements are printed using an
+//           in-order traversal, and an initial "[" and trailing "]"
+//           are printed before the first and after the last element.
+//           Does not print a newline. Returns os.
+// EXAMPLES: [ ]
+//           [ 5 ]
+//           [ 3 5 7 ]
+// NOTE:     The correct operation of this function depends on the
+//           BinarySearchTree Iterator, which in turn depends on some
+//           of the functions you must write.
+
+template <typename T, typename Compare>
+std::ostream &operator<<(std::ostream &os,
+                         const BinarySearchTree<T, Compare> &tree) {
+// DO NOT CHANGE THE IMPLEMENTATION OF THIS FUNCTION
+  os << "[ ";
+  for (T& elt : tree) {
+    os << elt << " ";
+  }
+  return os << "]";
+}
+
+#endif // DO NOT REMOVE!!
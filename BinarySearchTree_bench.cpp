@@ -0,0 +1,85 @@
+// Benchmarks BinarySearchTree insertion with and without a hint for
+// sorted, reverse-sorted and random key orders.
+//
+// Usage: BinarySearchTree_bench.exe [NUM_KEYS]
+
+#include "BinarySearchTree.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+using Tree = BinarySearchTree<int>;
+
+// EFFECTS: Returns the number of milliseconds taken to run fn once.
+template <typename Function>
+double time_ms(Function fn) {
+  auto start = chrono::steady_clock::now();
+  fn();
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration<double, milli>(stop - start).count();
+}
+
+// EFFECTS: Inserts keys into a new tree with the plain insert.
+size_t insert_plain(const vector<int> &keys) {
+  Tree tree;
+  for (int key : keys) {
+    tree.insert(key);
+  }
+  return tree.size();
+}
+
+// EFFECTS: Inserts keys into a new tree, passing the iterator returned
+//          by the previous insertion as the hint, except that keys
+//          greater than the current maximum are hinted with end().
+size_t insert_hinted(const vector<int> &keys) {
+  Tree tree;
+  Tree::Iterator hint = tree.end();
+  for (int key : keys) {
+    if (!tree.empty() && *tree.max_element() < key) {
+      hint = tree.end();
+    }
+    hint = tree.insert(hint, key);
+  }
+  return tree.size();
+}
+
+void report(const string &order, const vector<int> &keys) {
+  size_t plain_size = 0;
+  size_t hinted_size = 0;
+  double plain = time_ms([&]() { plain_size = insert_plain(keys); });
+  double hinted = time_ms([&]() { hinted_size = insert_hinted(keys); });
+  assert(plain_size == keys.size() && hinted_size == keys.size());
+
+  cout << left << setw(16) << order << right
+       << setw(12) << plain << " ms"
+       << setw(12) << hinted << " ms"
+       << setw(10) << plain / hinted << "x" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  int num_keys = argc > 1 ? atoi(argv[1]) : 10000;
+
+  vector<int> sorted(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    sorted[i] = i;
+  }
+  vector<int> reversed(sorted.rbegin(), sorted.rend());
+  vector<int> shuffled(sorted);
+  shuffle(shuffled.begin(), shuffled.end(), mt19937(280));
+
+  cout << fixed << setprecision(2);
+  cout << "inserting " << num_keys << " keys" << endl;
+  cout << left << setw(16) << "order" << right
+       << setw(15) << "insert" << setw(15) << "hinted insert"
+       << setw(11) << "speedup" << endl;
+  report("sorted", sorted);
+  report("reverse-sorted", reversed);
+  report("random", shuffled);
+}
@@ -1,468 +1,826 @@
-#include "BinarySearchTree.hpp"
-#include "unit_test_framework.hpp"
-#include <iostream>
-#include <string>
-#include <ostream>
-
-TEST(test_constructor) {
-    // create a tree with default constructor
-    BinarySearchTree<int> int_tree;
-}
-
-TEST(test_copy_constructor) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    int values[] = {5, 3, 7, 2, 4, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(tree.size() == 7);
-    ASSERT_TRUE(tree.height() == 3);
-
-    // create a tree from int tree
-    BinarySearchTree<int> new_tree(tree);
-
-    ASSERT_FALSE(new_tree.empty());
-    ASSERT_TRUE(new_tree.size() == 7);
-    ASSERT_TRUE(new_tree.height() == 3);
-
-    // modify new tree
-    new_tree.insert(9);
-
-    // test that tree and new tree are correct
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(tree.size() == 7);
-    ASSERT_TRUE(tree.height() == 3);
-
-    ASSERT_FALSE(new_tree.empty());
-    ASSERT_TRUE(new_tree.size() == 8);
-    ASSERT_TRUE(new_tree.height() == 4);
-}
-
-TEST(test_assignment) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    int values[] = {5, 3, 7, 2, 4, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(tree.size() == 7);
-    ASSERT_TRUE(tree.height() == 3);
-
-    // create a tree from int tree
-    BinarySearchTree<int> new_tree;
-
-    // insert values into new tree
-    for (int value : values) {
-        new_tree.insert(value);
-    }
-
-    // use assignment operator
-    new_tree = tree;
-
-    ASSERT_FALSE(new_tree.empty());
-    ASSERT_TRUE(new_tree.size() == 7);
-    ASSERT_TRUE(new_tree.height() == 3);
-
-    // modify new tree
-    new_tree.insert(9);
-
-    // test that tree and new tree are correct
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(tree.size() == 7);
-    ASSERT_TRUE(tree.height() == 3);
-
-    ASSERT_FALSE(new_tree.empty());
-    ASSERT_TRUE(new_tree.size() == 8);
-    ASSERT_TRUE(new_tree.height() == 4);
-
-    BinarySearchTree<int> new_tree2;
-
-    new_tree2 = new_tree;
-
-    ASSERT_FALSE(new_tree2.empty());
-    ASSERT_TRUE(new_tree2.size() == 8);
-    ASSERT_TRUE(new_tree2.height() == 4);
-    ASSERT_TRUE(new_tree2.check_sorting_invariant());
-
-    BinarySearchTree<int> empty;
-
-    new_tree2 = empty;
-    ASSERT_TRUE(new_tree2.empty());
-    ASSERT_TRUE(new_tree2.size() == 0);
-    ASSERT_TRUE(new_tree2.height() == 0);
-    ASSERT_TRUE(new_tree2.check_sorting_invariant());
-}
-
-TEST(test_empty) {
-    // create tree
-    BinarySearchTree<int> tree;
-
-    // test empty
-    ASSERT_TRUE(tree.empty());
-
-    // insert value
-    tree.insert(1);
-
-    // test not empty
-    ASSERT_FALSE(tree.empty());
-}
-
-TEST(test_height) {
-    // create a tree
-    BinarySearchTree<int> tree;
-
-    // insert value
-    tree.insert(1);
-    ASSERT_TRUE(tree.height() == 1);
-
-    // insert value
-    tree.insert(2);
-    ASSERT_TRUE(tree.height() == 2);
-
-    // insert value
-    BinarySearchTree<int>::Iterator iter = tree.insert(3);
-    ASSERT_TRUE(tree.height() == 3);
-
-    *iter = -1;
-    ASSERT_TRUE(tree.height() == 3 );
-    ASSERT_FALSE(tree.check_sorting_invariant());
-
-    tree.insert(-10);
-    tree.insert(-5);
-    tree.insert(-9);
-    tree.insert(-8);
-    ASSERT_TRUE(tree.height() == 5);
-}
-
-TEST(test_size) {
-    // create a tree
-    BinarySearchTree<int> tree;
-
-    // insert value
-    tree.insert(1);
-    ASSERT_TRUE(tree.size() == 1);
-
-    // insert value
-    tree.insert(2);
-    ASSERT_TRUE(tree.size() == 2);
-
-    // insert value
-    BinarySearchTree<int>::Iterator iter = tree.insert(3);
-    ASSERT_TRUE(tree.size() == 3);
-
-    *iter = -1;
-    ASSERT_TRUE(tree.size() == 3);
-}
-
-TEST(test_traverse_inorder) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    int values[] = {5, 3, 7, 2, 4, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    // create stream object to compare
-    std::ostringstream output;
-
-    // get output from inorder function
-    tree.traverse_inorder(output);
-
-    // create string for comparison
-    std::string output_str = output.str();
-    std::string expected_output = "2 3 4 5 6 7 8 ";
-
-    // compare output
-    ASSERT_TRUE(output_str == expected_output);
-}
-
-TEST(test_traverse_preorder) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    int values[] = {5, 3, 7, 2, 4, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    // create stream object to compare
-    std::ostringstream output;
-
-    // get output from inorder function
-    tree.traverse_preorder(output);
-
-    // create string for comparison
-    std::string output_str = output.str();
-    std::string expected_output = "5 3 2 4 7 6 8 ";
-
-    // compare output
-    ASSERT_TRUE(output_str == expected_output);
-}
-
-TEST(test_sorting_invariant) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-    int values[] = {5, 3, 7, 2, 4, 6};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-        ASSERT_TRUE(tree.check_sorting_invariant());
-    }
-
-    // insert value into tree
-    iter = tree.insert(8);
-
-    // test sorting invariant
-    ASSERT_TRUE(tree.check_sorting_invariant());
-
-    // modify element to break invariant
-    *iter = 1;
-
-    // test sorting invariant
-    ASSERT_FALSE(tree.check_sorting_invariant());
-
-    *iter = 8;
-    ASSERT_TRUE(tree.check_sorting_invariant());
-
-    BinarySearchTree<int> tree2;
-    ASSERT_TRUE(tree2.check_sorting_invariant());
-
-    tree2.insert(-10);
-    ASSERT_TRUE(tree2.check_sorting_invariant());
-
-    tree2.insert(-30);
-    tree2.insert(-9);
-    ASSERT_TRUE(tree2.check_sorting_invariant());
-
-}
-
-TEST(test_min_element) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-    int values[] = {5, 3, 7, 4, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    // create iterator to min element
-    iter = tree.min_element();
-    ASSERT_TRUE(*iter == 3);
-
-    // insert new min element
-    tree.insert(2);
-
-    // test min element
-    iter = tree.min_element();
-    ASSERT_TRUE(*iter == 2);
-}
-
-TEST(test_max_element) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-    BinarySearchTree<int>::Iterator null_iter;
-    int values[] = {5, 3, 7, 2, 4, 6};
-
-    iter = tree.max_element();
-    ASSERT_TRUE(iter == null_iter);
-    iter = tree.min_element();
-    ASSERT_TRUE(iter == null_iter);
-
-    iter = tree.insert(1);
-    ASSERT_TRUE(tree.min_element() == tree.max_element());
-    iter = tree.min_element();
-    ASSERT_TRUE(*iter == 1);
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    // create iterator to min element
-    iter = tree.max_element();
-    ASSERT_TRUE(*iter == 7);
-
-    // insert new min element
-    tree.insert(8);
-
-    // test min element
-    iter = tree.max_element();
-    ASSERT_TRUE(*iter == 8);
-}
-
-TEST(test_min_greater_than) {
-    // create a tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-    int values[] = {5, 3, 7, 2, 6, 8};
-
-    // insert values into tree
-    for (int value : values) {
-        tree.insert(value);
-    }
-
-    // test min greater than lowest
-    iter = tree.min_greater_than(1);
-    ASSERT_TRUE(*iter == 2);
-
-    // test min greater than highest
-    iter = tree.min_greater_than(7);
-    ASSERT_TRUE(*iter == 8);
-
-    // test min greater than traverse height
-    iter = tree.min_greater_than(5);
-    ASSERT_TRUE(*iter == 6);
-
-    // test min greater than
-    iter = tree.min_greater_than(3);
-    ASSERT_TRUE(*iter == 5);
-
-    // insert 4
-    tree.insert(4);
-
-    // test min greater than
-    iter = tree.min_greater_than(3);
-    ASSERT_TRUE(*iter == 4);
-
-    tree.insert(-1);
-
-    iter = tree.min_greater_than(0);
-    ASSERT_TRUE(*iter == 2);
-    iter = tree.min_greater_than(-1);
-    ASSERT_TRUE(*iter == 2);
-    iter = tree.min_greater_than(-2);
-    ASSERT_TRUE(*iter == -1);
-}
-
-TEST(test_insert) {
-    // create tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-
-    // insert first value
-    iter = tree.insert(5);
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(*iter == 5);
-    ASSERT_TRUE(tree.size() == 1);
-    ASSERT_TRUE(tree.height() == 1);
-    ASSERT_TRUE(tree.check_sorting_invariant());
-
-    // insert value to left
-    iter = tree.insert(3);
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(*iter == 3);
-    ASSERT_TRUE(tree.size() == 2);
-    ASSERT_TRUE(tree.height() == 2);
-    ASSERT_TRUE(tree.check_sorting_invariant());
-
-    // insert value to right
-    iter = tree.insert(7);
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(*iter == 7);
-    ASSERT_TRUE(tree.size() == 3);
-    ASSERT_TRUE(tree.height() == 2);
-    ASSERT_TRUE(tree.check_sorting_invariant());
-
-    // insert value to left
-    iter = tree.insert(2);
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(*iter == 2);
-    ASSERT_TRUE(tree.size() == 4);
-    ASSERT_TRUE(tree.height() == 3);
-    ASSERT_TRUE(tree.check_sorting_invariant());
-}
-
-TEST(test_find) {
-    // create tree
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int>::Iterator iter;
-    BinarySearchTree<int>::Iterator null_iter;
-    int values[] = {5, 3, 7, 2, 4, 6, 8};
-
-    // insert values
-    for (int value : values) {
-        tree.insert(value);
-        ASSERT_TRUE(tree.check_sorting_invariant());
-    }
-
-    ASSERT_FALSE(tree.empty());
-    ASSERT_TRUE(tree.size() == 7);
-    ASSERT_TRUE(tree.height() == 3);
-
-    // test find
-    iter = tree.find(7);
-    ASSERT_TRUE(*iter == 7);
-
-    iter = tree.find(0);
-    ASSERT_TRUE(iter == null_iter);
-
-    iter = tree.find(7);
-    *iter = 0;
-    ASSERT_TRUE(*iter == 0);
-
-    iter = tree.find(7);
-    ASSERT_TRUE(iter == null_iter);
-
-    iter = tree.find(-5);
-    ASSERT_TRUE(iter == null_iter);
-}
-
-TEST(bst_public_test) {
-  BinarySearchTree<int> tree;
-
-  tree.insert(5);
-
-  ASSERT_TRUE(tree.size() == 1);
-  ASSERT_TRUE(tree.height() == 1);
-
-  ASSERT_TRUE(tree.find(5) != tree.end());
-
-  tree.insert(7);
-  tree.insert(3);
-
-  ASSERT_TRUE(tree.check_sorting_invariant());
-  ASSERT_TRUE(*tree.max_element() == 7);
-  ASSERT_TRUE(*tree.min_element() == 3);
-  ASSERT_TRUE(*tree.min_greater_than(5) == 7);
-
-  std::cout << "cout << tree.to_string()" << std::endl;
-  std::cout << tree.to_string() << std::endl << std::endl;
-
-  std::cout << "cout << tree" << std::endl << "(uses iterators)" << std::endl;
-  std::cout << tree << std::endl << std::endl;
-
-  std::ostringstream oss_preorder;
-  tree.traverse_preorder(oss_preorder);
-  std::cout << "preorder" << std::endl;
-  std::cout << oss_preorder.str() << std::endl << std::endl;
-  ASSERT_TRUE(oss_preorder.str() == "5 3 7 ");
-
-  std::ostringstream oss_inorder;
-  tree.traverse_inorder(oss_inorder);
-  std::cout << "inorder" << std::endl;
-  std::cout << oss_inorder.str() << std::endl << std::endl;
-  ASSERT_TRUE(oss_inorder.str() == "3 5 7 ");
-}
-
+#include "BinarySearchTree.hpp"
+#include "unit_test_framework.hpp"
+#include <iostream>
+#include <string>
+#include <ostream>
+#include <utility>
+
+TEST(test_constructor) {
+    // create a tree with default constructor
+    BinarySearchTree<int> int_tree;
+}
+
+TEST(test_copy_constructor) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+
+    // create a tree from int tree
+    BinarySearchTree<int> new_tree(tree);
+
+    ASSERT_FALSE(new_tree.empty());
+    ASSERT_TRUE(new_tree.size() == 7);
+    ASSERT_TRUE(new_tree.height() == 3);
+
+    // modify new tree
+    new_tree.insert(9);
+
+    // test that tree and new tree are correct
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+
+    ASSERT_FALSE(new_tree.empty());
+    ASSERT_TRUE(new_tree.size() == 8);
+    ASSERT_TRUE(new_tree.height() == 4);
+}
+
+TEST(test_assignment) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+
+    // create a tree from int tree
+    BinarySearchTree<int> new_tree;
+
+    // insert values into new tree
+    for (int value : values) {
+        new_tree.insert(value);
+    }
+
+    // use assignment operator
+    new_tree = tree;
+
+    ASSERT_FALSE(new_tree.empty());
+    ASSERT_TRUE(new_tree.size() == 7);
+    ASSERT_TRUE(new_tree.height() == 3);
+
+    // modify new tree
+    new_tree.insert(9);
+
+    // test that tree and new tree are correct
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+
+    ASSERT_FALSE(new_tree.empty());
+    ASSERT_TRUE(new_tree.size() == 8);
+    ASSERT_TRUE(new_tree.height() == 4);
+
+    BinarySearchTree<int> new_tree2;
+
+    new_tree2 = new_tree;
+
+    ASSERT_FALSE(new_tree2.empty());
+    ASSERT_TRUE(new_tree2.size() == 8);
+    ASSERT_TRUE(new_tree2.height() == 4);
+    ASSERT_TRUE(new_tree2.check_sorting_invariant());
+
+    BinarySearchTree<int> empty;
+
+    new_tree2 = empty;
+    ASSERT_TRUE(new_tree2.empty());
+    ASSERT_TRUE(new_tree2.size() == 0);
+    ASSERT_TRUE(new_tree2.height() == 0);
+    ASSERT_TRUE(new_tree2.check_sorting_invariant());
+}
+
+TEST(test_empty) {
+    // create tree
+    BinarySearchTree<int> tree;
+
+    // test empty
+    ASSERT_TRUE(tree.empty());
+
+    // insert value
+    tree.insert(1);
+
+    // test not empty
+    ASSERT_FALSE(tree.empty());
+}
+
+TEST(test_height) {
+    // create a tree
+    BinarySearchTree<int> tree;
+
+    // insert value
+    tree.insert(1);
+    ASSERT_TRUE(tree.height() == 1);
+
+    // insert value
+    tree.insert(2);
+    ASSERT_TRUE(tree.height() == 2);
+
+    // insert value
+    BinarySearchTree<int>::Iterator iter = tree.insert(3);
+    ASSERT_TRUE(tree.height() == 3);
+
+    *iter = -1;
+    ASSERT_TRUE(tree.height() == 3 );
+    ASSERT_FALSE(tree.check_sorting_invariant());
+
+    tree.insert(-10);
+    tree.insert(-5);
+    tree.insert(-9);
+    tree.insert(-8);
+    ASSERT_TRUE(tree.height() == 5);
+}
+
+TEST(test_size) {
+    // create a tree
+    BinarySearchTree<int> tree;
+
+    // insert value
+    tree.insert(1);
+    ASSERT_TRUE(tree.size() == 1);
+
+    // insert value
+    tree.insert(2);
+    ASSERT_TRUE(tree.size() == 2);
+
+    // insert value
+    BinarySearchTree<int>::Iterator iter = tree.insert(3);
+    ASSERT_TRUE(tree.size() == 3);
+
+    *iter = -1;
+    ASSERT_TRUE(tree.size() == 3);
+}
+
+TEST(test_traverse_inorder) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // create stream object to compare
+    std::ostringstream output;
+
+    // get output from inorder function
+    tree.traverse_inorder(output);
+
+    // create string for comparison
+    std::string output_str = output.str();
+    std::string expected_output = "2 3 4 5 6 7 8 ";
+
+    // compare output
+    ASSERT_TRUE(output_str == expected_output);
+}
+
+TEST(test_traverse_preorder) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // create stream object to compare
+    std::ostringstream output;
+
+    // get output from inorder function
+    tree.traverse_preorder(output);
+
+    // create string for comparison
+    std::string output_str = output.str();
+    std::string expected_output = "5 3 2 4 7 6 8 ";
+
+    // compare output
+    ASSERT_TRUE(output_str == expected_output);
+}
+
+TEST(test_sorting_invariant) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+    int values[] = {5, 3, 7, 2, 4, 6};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+        ASSERT_TRUE(tree.check_sorting_invariant());
+    }
+
+    // insert value into tree
+    iter = tree.insert(8);
+
+    // test sorting invariant
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    // modify element to break invariant
+    *iter = 1;
+
+    // test sorting invariant
+    ASSERT_FALSE(tree.check_sorting_invariant());
+
+    *iter = 8;
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    BinarySearchTree<int> tree2;
+    ASSERT_TRUE(tree2.check_sorting_invariant());
+
+    tree2.insert(-10);
+    ASSERT_TRUE(tree2.check_sorting_invariant());
+
+    tree2.insert(-30);
+    tree2.insert(-9);
+    ASSERT_TRUE(tree2.check_sorting_invariant());
+
+}
+
+TEST(test_min_element) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+    int values[] = {5, 3, 7, 4, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // create iterator to min element
+    iter = tree.min_element();
+    ASSERT_TRUE(*iter == 3);
+
+    // insert new min element
+    tree.insert(2);
+
+    // test min element
+    iter = tree.min_element();
+    ASSERT_TRUE(*iter == 2);
+}
+
+TEST(test_max_element) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+    BinarySearchTree<int>::Iterator null_iter;
+    int values[] = {5, 3, 7, 2, 4, 6};
+
+    iter = tree.max_element();
+    ASSERT_TRUE(iter == null_iter);
+    iter = tree.min_element();
+    ASSERT_TRUE(iter == null_iter);
+
+    iter = tree.insert(1);
+    ASSERT_TRUE(tree.min_element() == tree.max_element());
+    iter = tree.min_element();
+    ASSERT_TRUE(*iter == 1);
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // create iterator to min element
+    iter = tree.max_element();
+    ASSERT_TRUE(*iter == 7);
+
+    // insert new min element
+    tree.insert(8);
+
+    // test min element
+    iter = tree.max_element();
+    ASSERT_TRUE(*iter == 8);
+}
+
+TEST(test_min_greater_than) {
+    // create a tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+    int values[] = {5, 3, 7, 2, 6, 8};
+
+    // insert values into tree
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // test min greater than lowest
+    iter = tree.min_greater_than(1);
+    ASSERT_TRUE(*iter == 2);
+
+    // test min greater than highest
+    iter = tree.min_greater_than(7);
+    ASSERT_TRUE(*iter == 8);
+
+    // test min greater than traverse height
+    iter = tree.min_greater_than(5);
+    ASSERT_TRUE(*iter == 6);
+
+    // test min greater than
+    iter = tree.min_greater_than(3);
+    ASSERT_TRUE(*iter == 5);
+
+    // insert 4
+    tree.insert(4);
+
+    // test min greater than
+    iter = tree.min_greater_than(3);
+    ASSERT_TRUE(*iter == 4);
+
+    tree.insert(-1);
+
+    iter = tree.min_greater_than(0);
+    ASSERT_TRUE(*iter == 2);
+    iter = tree.min_greater_than(-1);
+    ASSERT_TRUE(*iter == 2);
+    iter = tree.min_greater_than(-2);
+    ASSERT_TRUE(*iter == -1);
+}
+
+TEST(test_insert) {
+    // create tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+
+    // insert first value
+    iter = tree.insert(5);
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(*iter == 5);
+    ASSERT_TRUE(tree.size() == 1);
+    ASSERT_TRUE(tree.height() == 1);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    // insert value to left
+    iter = tree.insert(3);
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(*iter == 3);
+    ASSERT_TRUE(tree.size() == 2);
+    ASSERT_TRUE(tree.height() == 2);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    // insert value to right
+    iter = tree.insert(7);
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(*iter == 7);
+    ASSERT_TRUE(tree.size() == 3);
+    ASSERT_TRUE(tree.height() == 2);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    // insert value to left
+    iter = tree.insert(2);
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(*iter == 2);
+    ASSERT_TRUE(tree.size() == 4);
+    ASSERT_TRUE(tree.height() == 3);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+}
+
+TEST(test_find) {
+    // create tree
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+    BinarySearchTree<int>::Iterator null_iter;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    // insert values
+    for (int value : values) {
+        tree.insert(value);
+        ASSERT_TRUE(tree.check_sorting_invariant());
+    }
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+
+    // test find
+    iter = tree.find(7);
+    ASSERT_TRUE(*iter == 7);
+
+    iter = tree.find(0);
+    ASSERT_TRUE(iter == null_iter);
+
+    iter = tree.find(7);
+    *iter = 0;
+    ASSERT_TRUE(*iter == 0);
+
+    iter = tree.find(7);
+    ASSERT_TRUE(iter == null_iter);
+
+    iter = tree.find(-5);
+    ASSERT_TRUE(iter == null_iter);
+}
+
+TEST(bst_public_test) {
+  BinarySearchTree<int> tree;
+
+  tree.insert(5);
+
+  ASSERT_TRUE(tree.size() == 1);
+  ASSERT_TRUE(tree.height() == 1);
+
+  ASSERT_TRUE(tree.find(5) != tree.end());
+
+  tree.insert(7);
+  tree.insert(3);
+
+  ASSERT_TRUE(tree.check_sorting_invariant());
+  ASSERT_TRUE(*tree.max_element() == 7);
+  ASSERT_TRUE(*tree.min_element() == 3);
+  ASSERT_TRUE(*tree.min_greater_than(5) == 7);
+
+  std::cout << "cout << tree.to_string()" << std::endl;
+  std::cout << tree.to_string() << std::endl << std::endl;
+
+  std::cout << "cout << tree" << std::endl << "(uses iterators)" << std::endl;
+  std::cout << tree << std::endl << std::endl;
+
+  std::ostringstream oss_preorder;
+  tree.traverse_preorder(oss_preorder);
+  std::cout << "preorder" << std::endl;
+  std::cout << oss_preorder.str() << std::endl << std::endl;
+  ASSERT_TRUE(oss_preorder.str() == "5 3 7 ");
+
+  std::ostringstream oss_inorder;
+  tree.traverse_inorder(oss_inorder);
+  std::cout << "inorder" << std::endl;
+  std::cout << oss_inorder.str() << std::endl << std::endl;
+  ASSERT_TRUE(oss_inorder.str() == "3 5 7 ");
+}
+
+TEST(test_merge) {
+    // create trees with overlapping elements
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> other;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+    int other_values[] = {1, 4, 9, 10, 11, 12, 13, 14};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+    for (int value : other_values) {
+        other.insert(value);
+    }
+
+    // merge, keeping the element from tree for duplicates
+    tree.merge(other, [](int a, int) { return a; });
+
+    ASSERT_TRUE(other.empty());
+    ASSERT_TRUE(tree.size() == 14);
+    ASSERT_TRUE(tree.height() == 4);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    std::ostringstream oss_inorder;
+    tree.traverse_inorder(oss_inorder);
+    ASSERT_TRUE(oss_inorder.str() == "1 2 3 4 5 6 7 8 9 10 11 12 13 14 ");
+
+    // merging an empty tree rebalances without changing the elements
+    tree.merge(other, [](int a, int) { return a; });
+    ASSERT_TRUE(tree.size() == 14);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+}
+
+TEST(test_intersect) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> other;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+    int other_values[] = {1, 4, 6, 8, 9};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+    for (int value : other_values) {
+        other.insert(value);
+    }
+
+    tree.intersect(other, [](int a, int) { return a; });
+
+    ASSERT_TRUE(other.empty());
+    ASSERT_TRUE(tree.size() == 3);
+    ASSERT_TRUE(tree.height() == 2);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    std::ostringstream oss_inorder;
+    tree.traverse_inorder(oss_inorder);
+    ASSERT_TRUE(oss_inorder.str() == "4 6 8 ");
+}
+
+TEST(test_subtract) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> other;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+    int other_values[] = {1, 4, 6, 8, 9};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+    for (int value : other_values) {
+        other.insert(value);
+    }
+
+    tree.subtract(other);
+
+    ASSERT_TRUE(other.empty());
+    ASSERT_TRUE(tree.size() == 4);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+
+    std::ostringstream oss_inorder;
+    tree.traverse_inorder(oss_inorder);
+    ASSERT_TRUE(oss_inorder.str() == "2 3 5 7 ");
+
+    // subtracting everything leaves an empty tree
+    BinarySearchTree<int> same(tree);
+    tree.subtract(same);
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(test_split) {
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // split on a key in the tree
+    BinarySearchTree<int> upper = tree.split(5);
+
+    ASSERT_TRUE(tree.size() == 3);
+    ASSERT_TRUE(upper.size() == 4);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(upper.check_sorting_invariant());
+    ASSERT_TRUE(*tree.max_element() == 4);
+    ASSERT_TRUE(*upper.min_element() == 5);
+
+    // split on a key not in the tree
+    BinarySearchTree<int> top = upper.split(7);
+
+    std::ostringstream oss_upper;
+    upper.traverse_inorder(oss_upper);
+    ASSERT_TRUE(oss_upper.str() == "5 6 ");
+
+    std::ostringstream oss_top;
+    top.traverse_inorder(oss_top);
+    ASSERT_TRUE(oss_top.str() == "7 8 ");
+
+    // split past either end
+    BinarySearchTree<int> none = top.split(100);
+    ASSERT_TRUE(none.empty());
+    ASSERT_TRUE(top.size() == 2);
+
+    BinarySearchTree<int> all = top.split(-100);
+    ASSERT_TRUE(top.empty());
+    ASSERT_TRUE(all.size() == 2);
+}
+
+TEST(test_join) {
+    BinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    BinarySearchTree<int> upper = tree.split(6);
+    BinarySearchTree<int> joined = BinarySearchTree<int>::join(tree, upper);
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(upper.empty());
+    ASSERT_TRUE(joined.size() == 7);
+    ASSERT_TRUE(joined.height() <= 4);
+    ASSERT_TRUE(joined.check_sorting_invariant());
+
+    std::ostringstream oss_inorder;
+    joined.traverse_inorder(oss_inorder);
+    ASSERT_TRUE(oss_inorder.str() == "2 3 4 5 6 7 8 ");
+
+    // joining with an empty tree on either side
+    BinarySearchTree<int> empty;
+    BinarySearchTree<int> same = BinarySearchTree<int>::join(joined, empty);
+    ASSERT_TRUE(same.size() == 7);
+    BinarySearchTree<int> again = BinarySearchTree<int>::join(empty, same);
+    ASSERT_TRUE(again.size() == 7);
+    ASSERT_TRUE(again.check_sorting_invariant());
+}
+
+TEST(test_insert_hint) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int>::Iterator iter;
+
+    // ascending keys with end() as the hint
+    for (int value = 10; value < 20; ++value) {
+        iter = tree.insert(tree.end(), value);
+        ASSERT_TRUE(*iter == value);
+    }
+    ASSERT_TRUE(tree.size() == 10);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(*tree.max_element() == 19);
+
+    // descending keys with the previous result as the hint
+    iter = tree.begin();
+    for (int value = 9; value >= 0; --value) {
+        iter = tree.insert(iter, value);
+        ASSERT_TRUE(*iter == value);
+    }
+    ASSERT_TRUE(tree.size() == 20);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(*tree.min_element() == 0);
+
+    // hint with a left subtree: 25 goes just before 30
+    BinarySearchTree<int> small;
+    small.insert(30);
+    small.insert(20);
+    iter = small.insert(small.find(30), 25);
+    ASSERT_TRUE(*iter == 25);
+    ASSERT_TRUE(small.check_sorting_invariant());
+
+    // wrong hints fall back to a normal insert
+    iter = small.insert(small.end(), 22);
+    ASSERT_TRUE(*iter == 22);
+    iter = small.insert(small.find(20), 40);
+    ASSERT_TRUE(*iter == 40);
+    ASSERT_TRUE(small.size() == 5);
+    ASSERT_TRUE(small.check_sorting_invariant());
+    ASSERT_TRUE(*small.max_element() == 40);
+
+    // equivalent elements are not inserted again
+    iter = small.insert(small.find(25), 22);
+    ASSERT_TRUE(*iter == 22);
+    iter = small.insert(small.end(), 40);
+    ASSERT_TRUE(*iter == 40);
+    ASSERT_TRUE(small.size() == 5);
+}
+
+TEST(test_rebalance) {
+    BinarySearchTree<int> tree;
+    for (int value = 0; value < 15; ++value) {
+        tree.insert(tree.end(), value);
+    }
+    ASSERT_TRUE(tree.height() == 15);
+
+    tree.rebalance();
+
+    ASSERT_TRUE(tree.size() == 15);
+    ASSERT_TRUE(tree.height() == 4);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(*tree.min_element() == 0);
+    ASSERT_TRUE(*tree.max_element() == 14);
+}
+
+TEST(test_rebalance_large) {
+    // a chain far deeper than the stack of a build without optimization
+    const int count = 300000;
+    BinarySearchTree<int> tree;
+    for (int value = 0; value < count; ++value) {
+        tree.insert(tree.end(), value);
+    }
+
+    tree.rebalance();
+
+    ASSERT_TRUE(tree.size() == count);
+    ASSERT_TRUE(tree.height() == 19);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(*tree.min_element() == 0);
+    ASSERT_TRUE(*tree.max_element() == count - 1);
+    int expected = 0;
+    for (int value : tree) {
+        ASSERT_TRUE(value == expected);
+        ++expected;
+    }
+    ASSERT_TRUE(expected == count);
+}
+
+TEST(test_tall_tree) {
+    // copying, counting, iterating and destroying work on chains far
+    // deeper than the stack, without rebalance()
+    const int count = 300000;
+    BinarySearchTree<int> ascending;
+    BinarySearchTree<int> descending;
+    BinarySearchTree<int>::Iterator hint = descending.end();
+    for (int value = 0; value < count; ++value) {
+        ascending.insert(ascending.end(), value);
+        hint = descending.insert(hint, count - 1 - value);
+    }
+    ASSERT_TRUE(ascending.size() == count);
+    ASSERT_TRUE(descending.size() == count);
+
+    BinarySearchTree<int> copy(ascending);
+    ASSERT_TRUE(copy.size() == count);
+    int expected = 0;
+    for (int value : copy) {
+        ASSERT_TRUE(value == expected);
+        ++expected;
+    }
+    ASSERT_TRUE(expected == count);
+
+    copy = descending;
+    ASSERT_TRUE(copy.size() == count);
+    ASSERT_TRUE(*copy.min_element() == 0);
+    ASSERT_TRUE(*copy.min_greater_than(count - 2) == count - 1);
+
+    long long sum = 0;
+    copy.partition(4, [&sum](const BinarySearchTree<int>::Range &range) {
+        auto add = [&sum](int value) { sum += value; };
+        range.for_each(add);
+    });
+    ASSERT_TRUE(sum == static_cast<long long>(count) * (count - 1) / 2);
+}
+
+TEST(test_move) {
+    BinarySearchTree<std::string> tree;
+    tree.insert("kiwi");
+    tree.insert("apple");
+    tree.insert("mango");
+
+    // move construction takes the nodes
+    BinarySearchTree<std::string> moved(std::move(tree));
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.begin() == tree.end());
+    ASSERT_TRUE(moved.size() == 3);
+    ASSERT_TRUE(*moved.min_element() == "apple");
+
+    // move assignment frees the old nodes and takes the new ones
+    BinarySearchTree<std::string> assigned;
+    assigned.insert("old");
+    assigned = std::move(moved);
+    ASSERT_TRUE(moved.empty());
+    ASSERT_TRUE(assigned.size() == 3);
+    ASSERT_TRUE(assigned.find("old") == assigned.end());
+    ASSERT_TRUE(*assigned.max_element() == "mango");
+
+    // the moved-from tree is still usable
+    moved.insert("again");
+    ASSERT_TRUE(moved.size() == 1);
+}
+
+TEST(test_insert_rvalue) {
+    BinarySearchTree<std::string> tree;
+    std::string word(100, 'x');
+
+    BinarySearchTree<std::string>::Iterator iter = tree.insert(std::move(word));
+    ASSERT_TRUE(iter->size() == 100);
+    ASSERT_TRUE(tree.size() == 1);
+    ASSERT_TRUE(tree.find(std::string(100, 'x')) == iter);
+}
+
+TEST(test_extract) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> other;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    for (int value : values) {
+        tree.insert(value);
+    }
+
+    // extract the root, a leaf and a missing element
+    BinarySearchTree<int>::Node_handle root = tree.extract(5);
+    BinarySearchTree<int>::Node_handle leaf = tree.extract(8);
+    BinarySearchTree<int>::Node_handle missing = tree.extract(10);
+
+    ASSERT_FALSE(root.empty());
+    ASSERT_TRUE(root.value() == 5);
+    ASSERT_TRUE(leaf.value() == 8);
+    ASSERT_TRUE(missing.empty());
+    ASSERT_TRUE(tree.size() == 5);
+    ASSERT_TRUE(tree.check_sorting_invariant());
+    ASSERT_TRUE(*tree.max_element() == 7);
+
+    // move the nodes into another tree
+    int *address = &root.value();
+    BinarySearchTree<int>::Iterator iter = other.insert(std::move(root));
+    ASSERT_TRUE(root.empty());
+    ASSERT_TRUE(&*iter == address);
+    other.insert(std::move(leaf));
+    ASSERT_TRUE(other.size() == 2);
+    ASSERT_TRUE(other.check_sorting_invariant());
+
+    // an equivalent element is not replaced
+    BinarySearchTree<int>::Node_handle again = other.extract(8);
+    other.insert(8);
+    iter = other.insert(std::move(again));
+    ASSERT_FALSE(again.empty());
+    ASSERT_TRUE(other.size() == 2);
+
+    // inserting an empty handle does nothing
+    ASSERT_TRUE(other.insert(std::move(missing)) == other.end());
+}
+
 TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,414 @@
+#ifndef COMPACT_BINARY_SEARCH_TREE_HPP
+#define COMPACT_BINARY_SEARCH_TREE_HPP
+
+#include <algorithm>  //max
+#include <cassert>    //assert
+#include <cstdint>    //uint32_t
+#include <functional> //less
+#include <iostream>   //ostream
+#include <limits>     //numeric_limits
+#include <utility>    //move
+#include <vector>     //vector
+
+template <typename T, typename Compare = std::less<T>>
+class CompactBinarySearchTree {
+
+  // OVERVIEW: A binary search tree with the same interface and
+  // invariants as BinarySearchTree, for memory-bound workloads.
+  // Instead of allocating every node separately and linking nodes with
+  // pointers, all nodes live in one contiguous vector and refer to their
+  // children by 32-bit index. For small elements such as the
+  // std::pair<std::string, double> of a Map<std::string, double>, this
+  // removes a malloc header and 8 bytes of links from every node, and
+  // neighbouring nodes share cache lines.
+  //
+  // The tree does not rebalance, so there are no balance or colour bits
+  // to store alongside the indices.
+  //
+  // LIMITS: At most 2^32 - 1 elements. Erasing is not supported, so the
+  //         vector only ever grows.
+
+private:
+  using Index = std::uint32_t;
+
+  // Index of a missing child, playing the role of a null pointer
+  static constexpr Index NIL = std::numeric_limits<Index>::max();
+
+  struct Node {
+    Node(const T &datum_in, Index left_in, Index right_in)
+      : datum(datum_in), left(left_in), right(right_in) { }
+
+    Node(T &&datum_in, Index left_in, Index right_in)
+      : datum(std::move(datum_in)), left(left_in), right(right_in) { }
+
+    T datum;
+    Index left;
+    Index right;
+  };
+
+public:
+
+  // Default constructor
+  CompactBinarySearchTree()
+    : root(NIL) { }
+
+  // Copying is provided by std::vector: a copy has exactly the same
+  // structure because child indices are relative to the vector.
+  CompactBinarySearchTree(const CompactBinarySearchTree &other) = default;
+  CompactBinarySearchTree &
+  operator=(const CompactBinarySearchTree &rhs) = default;
+
+  // Move constructor
+  // (Takes the nodes of other, leaving it empty)
+  CompactBinarySearchTree(CompactBinarySearchTree &&other)
+    : nodes(std::move(other.nodes)), root(other.root) {
+    other.nodes.clear();
+    other.root = NIL;
+  }
+
+  // Move assignment operator
+  // (Frees the nodes of this tree and takes those of rhs, leaving it empty)
+  CompactBinarySearchTree &operator=(CompactBinarySearchTree &&rhs) {
+    if (this != &rhs) {
+      nodes = std::move(rhs.nodes);
+      root = rhs.root;
+      rhs.nodes.clear();
+      rhs.root = NIL;
+    }
+    return *this;
+  }
+
+  // EFFECTS: Returns whether this CompactBinarySearchTree is empty.
+  bool empty() const {
+    return root == NIL;
+  }
+
+  // EFFECTS: Returns the height of the tree.
+  size_t height() const {
+    return height_impl(root);
+  }
+
+  // EFFECTS: Returns the number of elements in this CompactBinarySearchTree.
+  size_t size() const {
+    return nodes.size();
+  }
+
+  // MODIFIES: this CompactBinarySearchTree
+  // EFFECTS : Reserves room for n elements, so that loading a tree of
+  //           known size allocates exactly once.
+  void reserve(size_t n) {
+    assert(n < NIL);
+    nodes.reserve(n);
+  }
+
+  // EFFECTS: Returns the number of bytes used to store the nodes.
+  size_t memory_usage() const {
+    return nodes.capacity() * sizeof(Node);
+  }
+
+  // EFFECTS: Traverses the tree using an in-order traversal,
+  //          printing each element to os in turn. Each element is followed
+  //          by a space (there will be an "extra" space at the end).
+  //          If the tree is empty, nothing is printed.
+  void traverse_inorder(std::ostream &os) const {
+    traverse_inorder_impl(root, os);
+  }
+
+  // EFFECTS: Traverses the tree using a pre-order traversal,
+  //          printing each element to os in turn. Each element is followed
+  //          by a space (there will be an "extra" space at the end).
+  //          If the tree is empty, nothing is printed.
+  void traverse_preorder(std::ostream &os) const {
+    traverse_preorder_impl(root, os);
+  }
+
+  // EFFECTS: Returns whether or not the sorting invariant holds on
+  //          the root of this CompactBinarySearchTree.
+  bool check_sorting_invariant() const {
+    return check_sorting_invariant_impl(root);
+  }
+
+  class Iterator {
+    // OVERVIEW: Iterator interface for CompactBinarySearchTree.
+    //           Iterates over the elements in ascending order. Because
+    //           it refers to its element by index, an Iterator stays
+    //           valid when other elements are inserted.
+
+  public:
+    Iterator()
+      : tree(nullptr), current(NIL) {}
+
+    // EFFECTS:  Returns the current element by reference.
+    // WARNING:  Any modification must result in a new value that compares
+    //           equal to the existing value.
+    T &operator*() const {
+      return tree->nodes[current].datum;
+    }
+
+    // EFFECTS:  Returns the current element by pointer.
+    // WARNING:  Any modification must result in a new value that compares
+    //           equal to the existing value.
+    T *operator->() const {
+      return &tree->nodes[current].datum;
+    }
+
+    // Prefix ++
+    Iterator &operator++() {
+      Index right = tree->nodes[current].right;
+      if (right != NIL) {
+        // If has right child, next element is minimum of right subtree
+        current = tree->min_element_impl(right);
+      }
+      else {
+        // Otherwise, look in the whole tree for the next biggest element
+        current = tree->min_greater_than_impl(tree->root,
+                                              tree->nodes[current].datum);
+      }
+      if (current == NIL) {
+        tree = nullptr;
+      }
+      return *this;
+    }
+
+    // Postfix ++ (implemented in terms of prefix ++)
+    Iterator operator++(int) {
+      Iterator result(*this);
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const Iterator &rhs) const {
+      return tree == rhs.tree && current == rhs.current;
+    }
+
+    bool operator!=(const Iterator &rhs) const {
+      return !(*this == rhs);
+    }
+
+  private:
+    friend class CompactBinarySearchTree;
+
+    CompactBinarySearchTree *tree;
+    Index current;
+
+    // End iterators never refer to a tree, so that every end iterator
+    // compares equal.
+    Iterator(const CompactBinarySearchTree *tree_in, Index current_in)
+      : tree(current_in == NIL
+             ? nullptr : const_cast<CompactBinarySearchTree *>(tree_in)),
+        current(current_in) { }
+
+  }; // CompactBinarySearchTree::Iterator
+  ////////////////////////////////////////
+
+  // Extracting nodes is not supported, since nodes cannot leave the
+  // vector, and neither is partitioning into Ranges for parallel visits.
+  // The types are declared, but never defined, so that Map can name
+  // them; calling Map::extract or Map::parallel_for_each on a CompactMap
+  // fails to compile.
+  class Node_handle;
+  class Range;
+
+  // EFFECTS : Returns an iterator to the first element
+  //           in this CompactBinarySearchTree.
+  Iterator begin() const {
+    return min_element();
+  }
+
+  // EFFECTS: Returns an iterator to past-the-end.
+  Iterator end() const {
+    return Iterator();
+  }
+
+  // EFFECTS: Returns an Iterator to the minimum element in this
+  //          CompactBinarySearchTree or an end Iterator if it is empty.
+  Iterator min_element() const {
+    return Iterator(this, min_element_impl(root));
+  }
+
+  // EFFECTS: Returns an Iterator to the maximum element in this
+  //          CompactBinarySearchTree or an end Iterator if it is empty.
+  Iterator max_element() const {
+    return Iterator(this, max_element_impl(root));
+  }
+
+  // EFFECTS: Returns an Iterator to the minimum element in this
+  //          CompactBinarySearchTree greater than the given value, or an
+  //          end Iterator if there is none.
+  Iterator min_greater_than(const T &value) const {
+    return Iterator(this, min_greater_than_impl(root, value));
+  }
+
+  // EFFECTS: Searches this tree for an element equivalent to query.
+  //          Returns an iterator to the existing element if found,
+  //          and an end iterator otherwise.
+  Iterator find(const T &query) const {
+    return Iterator(this, find_impl(root, query));
+  }
+
+  // REQUIRES: The given item is not already contained in this tree
+  // MODIFIES: this CompactBinarySearchTree
+  // EFFECTS : Inserts the element item into this CompactBinarySearchTree,
+  //           maintaining the sorting invariant.
+  Iterator insert(const T &item) {
+    assert(find(item) == end());
+    assert(nodes.size() < NIL);
+    Index added = static_cast<Index>(nodes.size());
+    nodes.emplace_back(item, NIL, NIL);
+    root = link_impl(root, added);
+    return Iterator(this, added);
+  }
+
+  // REQUIRES: The given item is not already contained in this tree
+  // MODIFIES: this CompactBinarySearchTree, item
+  // EFFECTS : Moves item into this CompactBinarySearchTree instead of
+  //           copying it, maintaining the sorting invariant.
+  Iterator insert(T &&item) {
+    assert(find(item) == end());
+    assert(nodes.size() < NIL);
+    Index added = static_cast<Index>(nodes.size());
+    nodes.emplace_back(std::move(item), NIL, NIL);
+    root = link_impl(root, added);
+    return Iterator(this, added);
+  }
+
+private:
+  std::vector<Node> nodes;
+  Index root;
+  Compare less;
+
+  // EFFECTS: Returns the height of the tree rooted at 'node'.
+  // NOTE:    This function must be tree recursive.
+  size_t height_impl(Index node) const {
+    if (node == NIL) {
+      return 0;
+    }
+    return 1 + std::max(height_impl(nodes[node].left),
+                        height_impl(nodes[node].right));
+  }
+
+  // EFFECTS : Returns the index of the node holding an element equivalent
+  //           to 'query' in the tree rooted at 'node', or NIL.
+  // NOTE: This function must be tail recursive.
+  Index find_impl(Index node, const T &query) const {
+    if (node == NIL) {
+      return NIL;
+    }
+    else if (less(query, nodes[node].datum)) {
+      return find_impl(nodes[node].left, query);
+    }
+    else if (less(nodes[node].datum, query)) {
+      return find_impl(nodes[node].right, query);
+    }
+    return node;
+  }
+
+  // REQUIRES: the element of 'added' is not in the tree rooted at 'node'
+  // MODIFIES: the tree rooted at 'node'
+  // EFFECTS : Links the unattached node 'added' into the tree rooted at
+  //           'node' as a leaf, and returns the new root of that tree.
+  // NOTE: This function must be linear recursive.
+  Index link_impl(Index node, Index added) {
+    if (node == NIL) {
+      return added;
+    }
+    else if (less(nodes[added].datum, nodes[node].datum)) {
+      Index left = link_impl(nodes[node].left, added);
+      nodes[node].left = left;
+    }
+    else {
+      Index right = link_impl(nodes[node].right, added);
+      nodes[node].right = right;
+    }
+    return node;
+  }
+
+  // EFFECTS : Returns the index of the minimum element in the tree rooted
+  //           at 'node', or NIL if it is empty.
+  // NOTE: This function must be tail recursive.
+  Index min_element_impl(Index node) const {
+    if (node == NIL || nodes[node].left == NIL) {
+      return node;
+    }
+    return min_element_impl(nodes[node].left);
+  }
+
+  // EFFECTS : Returns the index of the maximum element in the tree rooted
+  //           at 'node', or NIL if it is empty.
+  // NOTE: This function must be tail recursive.
+  Index max_element_impl(Index node) const {
+    if (node == NIL || nodes[node].right == NIL) {
+      return node;
+    }
+    return max_element_impl(nodes[node].right);
+  }
+
+  // EFFECTS : Returns the index of the smallest element in the tree
+  //           rooted at 'node' that is greater than 'val', or NIL.
+  // NOTE: This function must be linear recursive.
+  Index min_greater_than_impl(Index node, const T &val) const {
+    if (node == NIL) {
+      return NIL;
+    }
+    else if (less(val, nodes[node].datum)) {
+      Index in_left = min_greater_than_impl(nodes[node].left, val);
+      return in_left == NIL ? node : in_left;
+    }
+    return min_greater_than_impl(nodes[node].right, val);
+  }
+
+  // EFFECTS: Returns whether the sorting invariant holds on the tree
+  //          rooted at 'node'.
+  // NOTE:    This function must be tree recursive.
+  bool check_sorting_invariant_impl(Index node) const {
+    if (node == NIL) {
+      return true;
+    }
+    Index left = nodes[node].left;
+    Index right = nodes[node].right;
+    bool left_less = left == NIL || less(nodes[left].datum, nodes[node].datum);
+    bool right_greater = right == NIL
+                         || less(nodes[node].datum, nodes[right].datum);
+    return left_less && right_greater
+           && check_sorting_invariant_impl(left)
+           && check_sorting_invariant_impl(right);
+  }
+
+  // EFFECTS : Prints the tree rooted at 'node' in order to os.
+  // NOTE: This function must be tree recursive.
+  void traverse_inorder_impl(Index node, std::ostream &os) const {
+    if (node == NIL) {
+      return;
+    }
+    traverse_inorder_impl(nodes[node].left, os);
+    os << nodes[node].datum << " ";
+    traverse_inorder_impl(nodes[node].right, os);
+  }
+
+  // EFFECTS : Prints the tree rooted at 'node' in pre-order to os.
+  // NOTE: This function must be tree recursive.
+  void traverse_preorder_impl(Index node, std::ostream &os) const {
+    if (node == NIL) {
+      return;
+    }
+    os << nodes[node].datum << " ";
+    traverse_preorder_impl(nodes[node].left, os);
+    traverse_preorder_impl(nodes[node].right, os);
+  }
+
+}; // END of CompactBinarySearchTree class
+
+// MODIFIES: os
+// EFFECTS : Prints the elements in the tree to the given ostream in the
+//           same format as for BinarySearchTree, e.g. [ 3 5 7 ]
+template <typename T, typename Compare>
+std::ostream &operator<<(std::ostream &os,
+                         const CompactBinarySearchTree<T, Compare> &tree) {
+  os << "[ ";
+  for (T& elt : tree) {
+    os << elt << " ";
+  }
+  return os << "]";
+}
+
+#endif // COMPACT_BINARY_SEARCH_TREE_HPP
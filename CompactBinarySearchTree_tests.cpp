@@ -0,0 +1,103 @@
+#include "CompactBinarySearchTree.hpp"
+#include "unit_test_framework.hpp"
+#include <sstream>
+#include <string>
+#include <utility>
+
+TEST(test_empty) {
+    CompactBinarySearchTree<int> tree;
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.size() == 0);
+    ASSERT_TRUE(tree.height() == 0);
+    ASSERT_TRUE(tree.begin() == tree.end());
+    ASSERT_TRUE(tree.find(3) == tree.end());
+}
+
+TEST(test_insert_find) {
+    CompactBinarySearchTree<int> tree;
+    int values[] = {5, 3, 7, 2, 4, 6, 8};
+
+    for (int value : values) {
+        CompactBinarySearchTree<int>::Iterator iter = tree.insert(value);
+        ASSERT_TRUE(*iter == value);
+        ASSERT_TRUE(tree.check_sorting_invariant());
+    }
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_TRUE(tree.size() == 7);
+    ASSERT_TRUE(tree.height() == 3);
+    ASSERT_TRUE(*tree.find(6) == 6);
+    ASSERT_TRUE(tree.find(9) == tree.end());
+    ASSERT_TRUE(*tree.min_element() == 2);
+    ASSERT_TRUE(*tree.max_element() == 8);
+    ASSERT_TRUE(*tree.min_greater_than(5) == 6);
+    ASSERT_TRUE(tree.min_greater_than(8) == tree.end());
+
+    std::ostringstream oss_preorder;
+    tree.traverse_preorder(oss_preorder);
+    ASSERT_TRUE(oss_preorder.str() == "5 3 2 4 7 6 8 ");
+
+    std::ostringstream oss;
+    oss << tree;
+    ASSERT_TRUE(oss.str() == "[ 2 3 4 5 6 7 8 ]");
+}
+
+TEST(test_iterator_survives_growth) {
+    CompactBinarySearchTree<int> tree;
+    CompactBinarySearchTree<int>::Iterator first = tree.insert(0);
+
+    // force the node vector to reallocate several times
+    for (int value = 1; value < 100; ++value) {
+        tree.insert(value % 2 ? value : -value);
+    }
+
+    ASSERT_TRUE(*first == 0);
+    ASSERT_TRUE(first == tree.find(0));
+    ASSERT_TRUE(*++first == 1);
+}
+
+TEST(test_copy) {
+    CompactBinarySearchTree<std::string> tree;
+    tree.reserve(3);
+    tree.insert("kiwi");
+    tree.insert("apple");
+
+    CompactBinarySearchTree<std::string> copy(tree);
+    copy.insert("mango");
+
+    ASSERT_TRUE(tree.size() == 2);
+    ASSERT_TRUE(copy.size() == 3);
+    ASSERT_TRUE(copy.check_sorting_invariant());
+    ASSERT_TRUE(*copy.begin() == "apple");
+
+    tree = copy;
+    ASSERT_TRUE(tree.size() == 3);
+    ASSERT_TRUE(*tree.max_element() == "mango");
+}
+
+TEST(test_node_size) {
+    // two 32-bit indices instead of two pointers
+    CompactBinarySearchTree<std::pair<int, double>> tree;
+    tree.reserve(10);
+    ASSERT_TRUE(tree.memory_usage()
+                == 10 * (sizeof(std::pair<int, double>) + 8));
+}
+
+TEST(test_move) {
+    CompactBinarySearchTree<std::string> tree;
+    tree.insert(std::string("kiwi"));
+    tree.insert("apple");
+
+    CompactBinarySearchTree<std::string> moved(std::move(tree));
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.size() == 0);
+    ASSERT_TRUE(moved.size() == 2);
+
+    tree.insert("again");
+    tree = std::move(moved);
+    ASSERT_TRUE(moved.empty());
+    ASSERT_TRUE(tree.size() == 2);
+    ASSERT_TRUE(*tree.begin() == "apple");
+}
+
+TEST_MAIN()
@@ -1,184 +1,428 @@
-#ifndef MAP_HPP
-#define MAP_HPP
-/* Map.hpp
- *
- * Abstract data type representing a map of key-value pairs with
- * unique keys. A subset of the std::map interface
- * http://www.cplusplus.com/reference/map/map/
- *
- * By Andrew DeOrio <awdeorio@umich.edu>
- *    Amir Kamil    <akamil@umich.edu>
- *    James Juett   <jjuett@umich.edu>
- * Updated
- *   2016-11-23
- *
- * DO NOT modify the public interface. Modify anything else you need to.
- */
-
-#include "BinarySearchTree.hpp"
-#include <cassert>  //assert
-#include <utility>  //pair
-
-template <typename Key_type, typename Value_type,
-          typename Key_compare=std::less<Key_type> // default argument
-         >
-class Map {
-
-private:
-  // Type alias for an element, the combination of a key and mapped
-  // value stored in a std::pair.
-  // See http://www.cplusplus.com/reference/utility/pair/
-  using Pair_type = std::pair<Key_type, Value_type>;
-
-  // A custom comparator
-  class PairComp {
-    public:
-    bool operator()(Pair_type p1, Pair_type p2) const {
-      Key_compare K_comp;
-      return K_comp(p1.first, p2.first);
-    }
-  };
-
-public:
-
-  // OVERVIEW: Maps are associative containers that store elements
-  // formed by a combination of a key value and a mapped value,
-  // following a specific order.
-  //
-  // NOTE: This Map should be represented using a BinarySearchTree that
-  //       stores (key, value) pairs. See Pair_type above. You will
-  //       also need to define an appropriate comparator type (PairComp) for the
-  //       BinarySearchTree to use in comparing elements, so that they
-  //       are compared based on the key stored in the first member of
-  //       the pair, rather than the built-in behavior that compares the
-  //       both the key and the value stored in first/second of the pair.
-
-  // Type alias for iterator type. It is sufficient to use the Iterator
-  // from BinarySearchTree<Pair_type> since it will yield elements of Pair_type
-  // in the appropriate order for the Map.
-  using Iterator = typename BinarySearchTree<Pair_type, PairComp>::Iterator;
-
-  // You should add in a default constructor, destructor, copy
-  // constructor, and overloaded assignment operator, if appropriate.
-  // If these operations will work correctly without defining them,
-  // you should omit them. A user of the class must be able to create,
-  // copy, assign, and destroy Maps.
-
-  // EFFECTS : Returns whether this Map is empty.
-  bool empty() const;
-
-  // EFFECTS : Returns the number of elements in this Map.
-  // NOTE : size_t is an integral type from the STL
-  size_t size() const;
-
-  // EFFECTS : Searches this Map for an element with a key equivalent
-  //           to k and returns an Iterator to the associated value if found,
-  //           otherwise returns an end Iterator.
-  //
-  // HINT: Since Map is implemented using a BinarySearchTree that stores
-  //       (key, value) pairs, you'll need to construct a dummy value
-  //       using "Value_type()".
-  Iterator find(const Key_type& k) const {
-    Pair_type pair_to_find(k,Value_type());
-    return bst.find(pair_to_find);
-  }
-
-  // MODIFIES: this
-  // EFFECTS : Returns a reference to the mapped value for the given
-  //           key. If k matches the key of an element in the
-  //           container, the function returns a reference to its
-  //           mapped value. If k does not match the key of any
-  //           element in the container, the function inserts a new
-  //           element with that key and a value-initialized mapped
-  //           value and returns a reference to the mapped value.
-  //           Note: value-initialization for numeric types guarantees the
-  //           value will be 0 (rather than memory junk).
-  //
-  // HINT:     In the case the key was not found, and you must insert a
-  //           new element, use the expression {k, Value_type()} to create
-  //           that element. This ensures the proper value-initialization is done.
-  //
-  // HINT: http://www.cplusplus.com/reference/map/map/operator[]/
-  Value_type& operator[](const Key_type& k) {
-    Iterator pair_it = find(k);
-    if (pair_it == end()) {
-      Pair_type new_element(k, Value_type()); 
-      return (*(insert(new_element).first)).second; //std::pair<k, Value_type()>
-    }
-    else { //pair_it != end()
-      return (*pair_it).second;
-    }
-  }
-
-  // MODIFIES: this
-  // EFFECTS : Inserts the given element into this Map if the given key
-  //           is not already contained in the Map. If the key is
-  //           already in the Map, returns an iterator to the
-  //           corresponding existing element, along with the value
-  //           false. Otherwise, inserts the given element and returns
-  //           an iterator to the newly inserted element, along with
-  //           the value true.
-  std::pair<Iterator, bool> insert(const Pair_type &val){
-    Iterator val_it = find(val.first);
-    if (val_it == end()) {
-      std::pair<Iterator, bool> item(bst.insert(val), false);
-      return item;
-    }
-    else { //val_it != end()
-      std::pair<Iterator, bool> item(bst.insert(val), true);
-      return item;
-    }
-  }
-
-  // EFFECTS : Returns an iterator to the first key-value pair in this Map.
-  Iterator begin() const {
-    return bst.begin();
-  }
-
-  // EFFECTS : Returns an iterator to "past-the-end".
-  Iterator end() const {
-    return bst.end();
-  }
-
-
-
-  // OG stuff
-  //   // EFFECTS : Returns an iterator to the first key-value pair in this Map.
-  // Iterator begin() const;
-
-  // // EFFECTS : Returns an iterator to "past-the-end".
-  // Iterator end() const;
-
-
-
-
-private:
-  BinarySearchTree<Pair_type, PairComp> bst;
-  // Add a BinarySearchTree private member HERE.
-};
-
-template <typename K, typename V, typename C>
-bool Map<K, V, C>::empty() const {
-  return bst.empty();
-}
-
-template <typename K, typename V, typename C>
-size_t Map<K, V, C>::size() const {
-  return bst.size();
-}
-
-
-
-
-// You may implement member functions below using an "out-of-line" definition
-// or you may simply define them "in-line" in the class definition above.
-// If you choose to define them "out-of-line", here is an example.
-// (Note that we're using K, V, and C as shorthands for Key_type,
-// Value_type, and Key_compare, respectively - the compiler doesn't
-// mind, and will just match them up by position.)
-//    template <typename K, typename V, typename C>
-//    typename Map<K, V, C>::Iterator Map<K, V, C>::begin() const {
-//      // YOUR IMPLEMENTATION GOES HERE
-//    }
-
-#endif // DO NOT REMOVE!!!
+#ifndef MAP_HPP
+#define MAP_HPP
+/* Map.hpp
+ *
+ * Abstract data type representing a map of key-value pairs with
+ * unique keys. A subset of the std::map interface
+ * http://www.cplusplus.com/reference/map/map/
+ *
+ * By Andrew DeOrio <awdeorio@umich.edu>
+ *    Amir Kamil    <akamil@umich.edu>
+ *    James Juett   <jjuett@umich.edu>
+ * Updated
+ *   2016-11-23
+ *
+ * DO NOT modify the public interface. Modify anything else you need to.
+ */
+
+#include "BinarySearchTree.hpp"
+#include "CompactBinarySearchTree.hpp"
+#include "ThreadPool.hpp"
+#include <cassert>  //assert
+#include <utility>  //pair
+#include <vector>   //vector
+
+template <typename Key_type, typename Value_type,
+          typename Key_compare=std::less<Key_type>, // default argument
+          template <typename, typename> class Tree_type=BinarySearchTree
+         >
+class Map {
+
+private:
+  // Type alias for an element, the combination of a key and mapped
+  // value stored in a std::pair.
+  // See http://www.cplusplus.com/reference/utility/pair/
+  using Pair_type = std::pair<Key_type, Value_type>;
+
+  // A custom comparator
+  class PairComp {
+    public:
+    bool operator()(const Pair_type &p1, const Pair_type &p2) const {
+      Key_compare K_comp;
+      return K_comp(p1.first, p2.first);
+    }
+  };
+
+public:
+
+  // OVERVIEW: Maps are associative containers that store elements
+  // formed by a combination of a key value and a mapped value,
+  // following a specific order.
+  //
+  // NOTE: This Map should be represented using a BinarySearchTree that
+  //       stores (key, value) pairs. See Pair_type above. You will
+  //       also need to define an appropriate comparator type (PairComp) for the
+  //       BinarySearchTree to use in comparing elements, so that they
+  //       are compared based on the key stored in the first member of
+  //       the pair, rather than the built-in behavior that compares the
+  //       both the key and the value stored in first/second of the pair.
+
+  // NOTE: The tree type can be swapped for CompactBinarySearchTree to
+  //       store the elements in one contiguous array (see CompactMap
+  //       below). Only the std::map subset of the interface is available
+  //       then; merge, split, join and hinted insertion need the default
+  //       BinarySearchTree.
+
+  // Type alias for iterator type. It is sufficient to use the Iterator
+  // from BinarySearchTree<Pair_type> since it will yield elements of Pair_type
+  // in the appropriate order for the Map.
+  using Iterator = typename Tree_type<Pair_type, PairComp>::Iterator;
+
+  // Type alias for a handle that owns an element extracted from a Map,
+  // which can be inserted into another Map without allocating.
+  using Node_handle = typename Tree_type<Pair_type, PairComp>::Node_handle;
+
+  // You should add in a default constructor, destructor, copy
+  // constructor, and overloaded assignment operator, if appropriate.
+  // If these operations will work correctly without defining them,
+  // you should omit them. A user of the class must be able to create,
+  // copy, assign, and destroy Maps.
+  //
+  // NOTE: The implicitly generated move constructor and move assignment
+  //       operator move the underlying tree, so returning a Map by value
+  //       does not copy its elements.
+
+  // EFFECTS : Returns whether this Map is empty.
+  bool empty() const;
+
+  // EFFECTS : Returns the number of elements in this Map.
+  // NOTE : size_t is an integral type from the STL
+  size_t size() const;
+
+  // EFFECTS : Searches this Map for an element with a key equivalent
+  //           to k and returns an Iterator to the associated value if found,
+  //           otherwise returns an end Iterator.
+  //
+  // HINT: Since Map is implemented using a BinarySearchTree that stores
+  //       (key, value) pairs, you'll need to construct a dummy value
+  //       using "Value_type()".
+  Iterator find(const Key_type& k) const {
+    Pair_type pair_to_find(k,Value_type());
+    return bst.find(pair_to_find);
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Returns a reference to the mapped value for the given
+  //           key. If k matches the key of an element in the
+  //           container, the function returns a reference to its
+  //           mapped value. If k does not match the key of any
+  //           element in the container, the function inserts a new
+  //           element with that key and a value-initialized mapped
+  //           value and returns a reference to the mapped value.
+  //           Note: value-initialization for numeric types guarantees the
+  //           value will be 0 (rather than memory junk).
+  //
+  // HINT:     In the case the key was not found, and you must insert a
+  //           new element, use the expression {k, Value_type()} to create
+  //           that element. This ensures the proper value-initialization is done.
+  //
+  // HINT: http://www.cplusplus.com/reference/map/map/operator[]/
+  Value_type& operator[](const Key_type& k) {
+    Iterator pair_it = find(k);
+    if (pair_it == end()) {
+      return bst.insert(Pair_type(k, Value_type()))->second;
+    }
+    else { //pair_it != end()
+      return (*pair_it).second;
+    }
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Inserts the given element into this Map if the given key
+  //           is not already contained in the Map. If the key is
+  //           already in the Map, returns an iterator to the
+  //           corresponding existing element, along with the value
+  //           false. Otherwise, inserts the given element and returns
+  //           an iterator to the newly inserted element, along with
+  //           the value true.
+  std::pair<Iterator, bool> insert(const Pair_type &val){
+    Iterator val_it = find(val.first);
+    if (val_it == end()) {
+      std::pair<Iterator, bool> item(bst.insert(val), true);
+      return item;
+    }
+    else { //val_it != end()
+      std::pair<Iterator, bool> item(val_it, false);
+      return item;
+    }
+  }
+
+  // MODIFIES: this, val
+  // EFFECTS : Same as insert(const Pair_type &), but moves val into the
+  //           Map instead of copying it.
+  std::pair<Iterator, bool> insert(Pair_type &&val) {
+    Iterator val_it = find(val.first);
+    if (val_it == end()) {
+      return std::pair<Iterator, bool>(bst.insert(std::move(val)), true);
+    }
+    return std::pair<Iterator, bool>(val_it, false);
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Removes the element with key k from this Map and returns a
+  //           handle that owns it, or an empty handle if k is not in the
+  //           Map. No element is copied or freed.
+  Node_handle extract(const Key_type &k) {
+    return bst.extract(Pair_type(k, Value_type()));
+  }
+
+  // MODIFIES: this, handle
+  // EFFECTS : Inserts the element owned by handle without allocating,
+  //           unless handle is empty (returns an end Iterator) or its key
+  //           is already in the Map (returns an Iterator to the existing
+  //           element and leaves handle unchanged).
+  Iterator insert(Node_handle &&handle) {
+    return bst.insert(std::move(handle));
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Inserts the given element as close as possible to just
+  //           before hint, if its key is not already in the Map, and
+  //           returns an iterator to the element with that key. Runs in
+  //           constant time when the element belongs immediately before
+  //           hint, e.g. when loading ascending keys with end() as the
+  //           hint. Call rebalance() after loading sorted input.
+  Iterator insert(Iterator hint, const Pair_type &val) {
+    return bst.insert(hint, val);
+  }
+
+  // MODIFIES: this, val
+  // EFFECTS : Same as above, but moves val into the Map instead of
+  //           copying it.
+  Iterator insert(Iterator hint, Pair_type &&val) {
+    return bst.insert(hint, std::move(val));
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Rebuilds the underlying tree with minimum height.
+  void rebalance() {
+    bst.rebalance();
+  }
+
+  // REQUIRES: combine_fn(a, b) can be called with two Value_types and
+  //           returns a Value_type
+  // MODIFIES: this, other
+  // EFFECTS : Moves every element of other into this Map. Where both
+  //           Maps contain the same key, the mapped value becomes
+  //           combine_fn(value in this, value in other). other is left
+  //           empty. Runs in O(n + m) and leaves the tree balanced.
+  // EXAMPLE : counts.merge(shard_counts, std::plus<double>());
+  template <typename Combine>
+  void merge(Map &other, Combine combine_fn) {
+    bst.merge(other.bst, combine_values(combine_fn));
+  }
+
+  // REQUIRES: combine_fn(a, b) can be called with two Value_types and
+  //           returns a Value_type
+  // MODIFIES: this, other
+  // EFFECTS : Keeps only the keys of this Map that are also in other,
+  //           with mapped values combine_fn(value in this, value in
+  //           other). other is left empty. Runs in O(n + m).
+  template <typename Combine>
+  void intersect(Map &other, Combine combine_fn) {
+    bst.intersect(other.bst, combine_values(combine_fn));
+  }
+
+  // MODIFIES: this, other
+  // EFFECTS : Removes every key of this Map that is also in other.
+  //           other is left empty. Runs in O(n + m).
+  void subtract(Map &other) {
+    bst.subtract(other.bst);
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Removes every element whose key is not less than k from
+  //           this Map and returns them as a new Map. No elements are
+  //           copied; runs in time proportional to the tree height.
+  Map split(const Key_type &k) {
+    Map not_less;
+    Tree_type<Pair_type, PairComp> upper =
+      bst.split(Pair_type(k, Value_type()));
+    not_less.bst.swap(upper);
+    return not_less;
+  }
+
+  // REQUIRES: every key in left is less than every key in right
+  // MODIFIES: left, right
+  // EFFECTS : Returns a Map holding the elements of both left and right,
+  //           leaving them empty. No elements are copied; runs in time
+  //           proportional to the height of left.
+  static Map join(Map &left, Map &right) {
+    Map result;
+    Tree_type<Pair_type, PairComp> joined =
+      Tree_type<Pair_type, PairComp>::join(left.bst, right.bst);
+    result.bst.swap(joined);
+    return result;
+  }
+
+  // REQUIRES: Tree_type is CompactBinarySearchTree
+  // MODIFIES: this
+  // EFFECTS : Reserves room for n elements, so that loading a Map of
+  //           known size allocates its nodes exactly once.
+  void reserve(size_t n) {
+    bst.reserve(n);
+  }
+
+  // REQUIRES: fn may be called concurrently on different elements, and
+  //           executor is a ThreadPool or has the same size() and
+  //           run(count, task) members
+  // MODIFIES: this, as fn modifies the mapped values
+  // EFFECTS : Calls fn(element) once for every (key, value) pair in this
+  //           Map. The tree is split into roughly equal key ranges, one
+  //           or two for each thread of executor, and the ranges are
+  //           visited concurrently. fn must not change the keys.
+  // EXAMPLE : counts.parallel_for_each([](auto &p) { p.second = log(p.second); },
+  //                                    pool);
+  template <typename Function, typename Executor>
+  void parallel_for_each(Function fn, Executor &executor) {
+    std::vector<Range> ranges = partition(executor.size());
+    executor.run(ranges.size(), [&](size_t i) {
+      ranges[i].for_each(fn);
+    });
+  }
+
+  // REQUIRES: transform may be called concurrently on different elements,
+  //           reduce is associative and identity is its identity element
+  //           (reduce(identity, x) == x), and executor is as for
+  //           parallel_for_each
+  // EFFECTS : Returns identity reduced with transform(element) for every
+  //           element, in ascending key order:
+  //             reduce(...reduce(reduce(identity, t(first)), t(second))...)
+  //           Each key range is reduced concurrently and the partial
+  //           results are combined in key order, so reduce does not need
+  //           to be commutative.
+  //           transform receives each element by const reference.
+  template <typename Result, typename Transform, typename Reduce,
+            typename Executor>
+  Result parallel_reduce(Result identity, Transform transform,
+                         Reduce reduce, Executor &executor) const {
+    std::vector<Range> ranges = partition(executor.size());
+    std::vector<Result> partials(ranges.size(), identity);
+    executor.run(ranges.size(), [&](size_t i) {
+      Result &partial = partials[i];
+      auto visit = [&](const Pair_type &element) {
+        partial = reduce(partial, transform(element));
+      };
+      ranges[i].for_each(visit);
+    });
+
+    Result result = identity;
+    for (const Result &partial : partials) {
+      result = reduce(result, partial);
+    }
+    return result;
+  }
+
+  // EFFECTS : Returns an iterator to the first key-value pair in this Map.
+  Iterator begin() const {
+    return bst.begin();
+  }
+
+  // EFFECTS : Returns an iterator to "past-the-end".
+  Iterator end() const {
+    return bst.end();
+  }
+
+
+
+  // OG stuff
+  //   // EFFECTS : Returns an iterator to the first key-value pair in this Map.
+  // Iterator begin() const;
+
+  // // EFFECTS : Returns an iterator to "past-the-end".
+  // Iterator end() const;
+
+
+
+
+private:
+  using Range = typename Tree_type<Pair_type, PairComp>::Range;
+
+  // EFFECTS : Returns the elements of this Map as contiguous key ranges
+  //           in ascending order, about 'parts' of roughly equal size.
+  std::vector<Range> partition(size_t parts) const {
+    std::vector<Range> ranges;
+    bst.partition(parts, [&ranges](const Range &range) {
+      ranges.push_back(range);
+    });
+    return ranges;
+  }
+
+  // EFFECTS : Adapts a combine function on mapped values to one on
+  //           (key, value) pairs with equivalent keys.
+  template <typename Combine>
+  static auto combine_values(Combine combine_fn) {
+    return [combine_fn](const Pair_type &lhs, const Pair_type &rhs) {
+      return Pair_type(lhs.first, combine_fn(lhs.second, rhs.second));
+    };
+  }
+
+  Tree_type<Pair_type, PairComp> bst;
+  // Add a BinarySearchTree private member HERE.
+};
+
+template <typename K, typename V, typename C,
+          template <typename, typename> class T>
+bool Map<K, V, C, T>::empty() const {
+  return bst.empty();
+}
+
+template <typename K, typename V, typename C,
+          template <typename, typename> class T>
+size_t Map<K, V, C, T>::size() const {
+  return bst.size();
+}
+
+
+// A Map whose elements are stored in a CompactBinarySearchTree, which
+// uses less memory per element than the default BinarySearchTree.
+template <typename Key_type, typename Value_type,
+          typename Key_compare=std::less<Key_type>>
+using CompactMap = Map<Key_type, Value_type, Key_compare,
+                       CompactBinarySearchTree>;
+
+// EFFECTS : Returns a Map with every key of lhs and rhs. Keys in both map
+//           to combine_fn(lhs value, rhs value). Runs in O(n + m).
+template <typename K, typename V, typename C, typename Combine>
+Map<K, V, C> set_union(const Map<K, V, C> &lhs, const Map<K, V, C> &rhs,
+                       Combine combine_fn) {
+  Map<K, V, C> result(lhs);
+  Map<K, V, C> other(rhs);
+  result.merge(other, combine_fn);
+  return result;
+}
+
+// EFFECTS : Returns a Map with the keys that are in both lhs and rhs,
+//           mapped to combine_fn(lhs value, rhs value). Runs in O(n + m).
+template <typename K, typename V, typename C, typename Combine>
+Map<K, V, C> set_intersection(const Map<K, V, C> &lhs,
+                              const Map<K, V, C> &rhs, Combine combine_fn) {
+  Map<K, V, C> result(lhs);
+  Map<K, V, C> other(rhs);
+  result.intersect(other, combine_fn);
+  return result;
+}
+
+// EFFECTS : Returns a Map with the elements of lhs whose keys are not
+//           in rhs. Runs in O(n + m).
+template <typename K, typename V, typename C>
+Map<K, V, C> set_difference(const Map<K, V, C> &lhs,
+                            const Map<K, V, C> &rhs) {
+  Map<K, V, C> result(lhs);
+  Map<K, V, C> other(rhs);
+  result.subtract(other);
+  return result;
+}
+
+// You may implement member functions below using an "out-of-line" definition
+// or you may simply define them "in-line" in the class definition above.
+// If you choose to define them "out-of-line", here is an example.
+// (Note that we're using K, V, and C as shorthands for Key_type,
+// Value_type, and Key_compare, respectively - the compiler doesn't
+// mind, and will just match them up by position.)
+//    template <typename K, typename V, typename C>
+//    typename Map<K, V, C>::Iterator Map<K, V, C>::begin() const {
+//      // YOUR IMPLEMENTATION GOES HERE
+//    }
+
+#endif // DO NOT REMOVE!!!
@@ -0,0 +1,74 @@
+// Compares the heap memory used by Map and CompactMap for a large
+// Map<std::string, double>, the shape of the classifier's word counts.
+//
+// Usage: Map_bench.exe [NUM_KEYS]
+
+#include "Map.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <malloc.h> // mallinfo2 (glibc)
+
+using namespace std;
+
+// EFFECTS: Returns the number of bytes currently allocated from the heap,
+//          including malloc's own bookkeeping.
+size_t heap_in_use() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// EFFECTS: Fills the map returned by make_map with keys, reporting the
+//          heap memory it holds and the time taken to look up every key.
+template <typename Make_map>
+void report(const string &name, const vector<string> &keys,
+            Make_map make_map) {
+  size_t before = heap_in_use();
+  auto *map = make_map();
+  for (const string &key : keys) {
+    (*map)[key] += 1;
+  }
+  size_t bytes = heap_in_use() - before;
+
+  double sum = 0;
+  auto start = chrono::steady_clock::now();
+  for (const string &key : keys) {
+    sum += map->find(key)->second;
+  }
+  auto stop = chrono::steady_clock::now();
+  if (sum != keys.size()) {
+    cout << "error: lookups found " << sum << " keys" << endl;
+  }
+
+  cout << left << setw(12) << name << right
+       << setw(12) << bytes / 1024 << " KiB"
+       << setw(10) << double(bytes) / keys.size() << " B/elt"
+       << setw(10) << chrono::duration<double, milli>(stop - start).count()
+       << " ms lookup" << endl;
+  delete map;
+}
+
+int main(int argc, char *argv[]) {
+  int num_keys = argc > 1 ? atoi(argv[1]) : 200000;
+
+  // Distinct short words in pseudo-random order, as in the training data
+  vector<string> keys;
+  keys.reserve(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    unsigned scrambled = static_cast<unsigned>(i) * 2654435761u;
+    keys.push_back("w" + to_string(scrambled));
+  }
+
+  cout << fixed << setprecision(1);
+  cout << num_keys << " keys in a Map<string, double>" << endl;
+  report("Map", keys, []() { return new Map<string, double>; });
+  report("CompactMap", keys, []() { return new CompactMap<string, double>; });
+  report("(reserved)", keys, [&keys]() {
+    auto *map = new CompactMap<string, double>;
+    map->reserve(keys.size());
+    return map;
+  });
+}
@@ -1,10 +1,305 @@
-#include "Map.hpp"
-#include "unit_test_framework.hpp"
-
-
-TEST(test_stub) {
-    // Add your tests here
-    ASSERT_TRUE(true);
-}
-
-TEST_MAIN()
+#include "Map.hpp"
+#include "unit_test_framework.hpp"
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+TEST(test_stub) {
+    // Add your tests here
+    ASSERT_TRUE(true);
+}
+
+TEST(test_insert_existing_key) {
+    Map<std::string, double> counts;
+    std::pair<Map<std::string, double>::Iterator, bool> first =
+        counts.insert({ "card", 3 });
+    ASSERT_TRUE(first.second);
+    ASSERT_EQUAL((*first.first).second, 3);
+
+    std::pair<Map<std::string, double>::Iterator, bool> second =
+        counts.insert({ "card", 5 });
+    ASSERT_TRUE(!second.second);
+    ASSERT_TRUE(second.first == first.first);
+    ASSERT_EQUAL(counts["card"], 3);
+    ASSERT_EQUAL(counts.size(), 1u);
+}
+
+TEST(test_merge) {
+    Map<std::string, double> counts;
+    Map<std::string, double> shard;
+    counts["card"] = 3;
+    counts["euchre"] = 1;
+    shard["card"] = 2;
+    shard["stack"] = 4;
+
+    counts.merge(shard, std::plus<double>());
+
+    ASSERT_TRUE(shard.empty());
+    ASSERT_EQUAL(counts.size(), 3u);
+    ASSERT_EQUAL(counts["card"], 5);
+    ASSERT_EQUAL(counts["euchre"], 1);
+    ASSERT_EQUAL(counts["stack"], 4);
+}
+
+TEST(test_merge_large) {
+    // big enough that merging one element per stack frame would overflow
+    // the stack of a build without optimization
+    const int n = 150000;
+    std::vector<int> keys;
+    for (int key = 0; key < 2 * n; ++key) {
+        keys.push_back(key);
+    }
+    // random insertion order keeps the trees shallow
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(280));
+    Map<int, int> evens;
+    Map<int, int> threes;
+    for (int key : keys) {
+        if (key % 2 == 0) {
+            evens[key] = 1;
+        }
+        if (key % 3 == 0) {
+            threes[key] = 2;
+        }
+    }
+    size_t expected_size = evens.size() + threes.size() - (2 * n + 5) / 6;
+
+    evens.merge(threes, std::plus<int>());
+
+    ASSERT_TRUE(threes.empty());
+    ASSERT_EQUAL(evens.size(), expected_size);
+    int previous = -1;
+    for (auto &p : evens) {
+        ASSERT_TRUE(p.first > previous);
+        int expected = (p.first % 2 == 0) + 2 * (p.first % 3 == 0);
+        ASSERT_EQUAL(p.second, expected);
+        previous = p.first;
+    }
+}
+
+TEST(test_set_union) {
+    Map<int, int> lhs;
+    Map<int, int> rhs;
+    for (int i = 0; i < 10; ++i) {
+        lhs[i] = i;
+        rhs[i + 5] = 100;
+    }
+
+    Map<int, int> result = set_union(lhs, rhs, std::plus<int>());
+
+    // inputs are unchanged
+    ASSERT_EQUAL(lhs.size(), 10u);
+    ASSERT_EQUAL(rhs.size(), 10u);
+
+    ASSERT_EQUAL(result.size(), 15u);
+    ASSERT_EQUAL(result[0], 0);
+    ASSERT_EQUAL(result[7], 107);
+    ASSERT_EQUAL(result[14], 100);
+}
+
+TEST(test_set_intersection) {
+    Map<int, int> lhs;
+    Map<int, int> rhs;
+    for (int i = 0; i < 10; ++i) {
+        lhs[i] = i;
+        rhs[i + 5] = 100;
+    }
+
+    Map<int, int> result =
+        set_intersection(lhs, rhs, [](int a, int b) { return a * b; });
+
+    ASSERT_EQUAL(result.size(), 5u);
+    int expected_key = 5;
+    for (auto &p : result) {
+        ASSERT_EQUAL(p.first, expected_key);
+        ASSERT_EQUAL(p.second, 100 * expected_key);
+        ++expected_key;
+    }
+}
+
+TEST(test_set_difference) {
+    Map<int, int> lhs;
+    Map<int, int> rhs;
+    for (int i = 0; i < 10; ++i) {
+        lhs[i] = i;
+        rhs[i + 5] = 100;
+    }
+
+    Map<int, int> result = set_difference(lhs, rhs);
+
+    ASSERT_EQUAL(result.size(), 5u);
+    ASSERT_TRUE(result.find(4) != result.end());
+    ASSERT_TRUE(result.find(5) == result.end());
+}
+
+TEST(test_split_join) {
+    Map<std::string, double> words;
+    words["apple"] = 1;
+    words["kiwi"] = 2;
+    words["mango"] = 3;
+    words["zucchini"] = 4;
+
+    Map<std::string, double> upper = words.split("lemon");
+
+    ASSERT_EQUAL(words.size(), 2u);
+    ASSERT_EQUAL(upper.size(), 2u);
+    ASSERT_TRUE(words.find("kiwi") != words.end());
+    ASSERT_TRUE(upper.find("mango") != upper.end());
+    ASSERT_TRUE(upper.find("kiwi") == upper.end());
+
+    Map<std::string, double> joined = Map<std::string, double>::join(words, upper);
+
+    ASSERT_TRUE(words.empty());
+    ASSERT_TRUE(upper.empty());
+    ASSERT_EQUAL(joined.size(), 4u);
+    ASSERT_EQUAL(joined["zucchini"], 4);
+}
+
+TEST(test_insert) {
+    Map<std::string, double> words;
+
+    auto result = words.insert({"hello", 1});
+    ASSERT_TRUE(result.second);
+    ASSERT_EQUAL(result.first->second, 1);
+
+    // inserting an existing key leaves the value alone
+    result = words.insert({"hello", 2});
+    ASSERT_FALSE(result.second);
+    ASSERT_EQUAL(result.first->second, 1);
+    ASSERT_EQUAL(words.size(), 1u);
+}
+
+TEST(test_insert_hint) {
+    Map<int, double> sorted;
+    for (int key = 0; key < 100; ++key) {
+        auto it = sorted.insert(sorted.end(), {key, key * 0.5});
+        ASSERT_EQUAL(it->first, key);
+    }
+    ASSERT_EQUAL(sorted.size(), 100u);
+
+    // an existing key is found rather than inserted
+    auto it = sorted.insert(sorted.end(), {50, -1.0});
+    ASSERT_EQUAL(it->second, 25.0);
+    ASSERT_EQUAL(sorted.size(), 100u);
+
+    sorted.rebalance();
+    int expected_key = 0;
+    for (auto &p : sorted) {
+        ASSERT_EQUAL(p.first, expected_key);
+        ++expected_key;
+    }
+}
+
+TEST(test_compact_map) {
+    CompactMap<std::string, double> words;
+    words.reserve(3);
+    words["hello"] = 1;
+    words.insert({"world", 2});
+    words.insert({"pi", 3.14159});
+
+    ASSERT_EQUAL(words.size(), 3u);
+    ASSERT_FALSE(words.insert({"pi", 0}).second);
+    ASSERT_EQUAL(words["world"], 2);
+
+    std::string keys;
+    for (auto &p : words) {
+        keys += p.first + " ";
+    }
+    ASSERT_EQUAL(keys, "hello pi world ");
+
+    CompactMap<std::string, double> copy(words);
+    copy["extra"] = 4;
+    ASSERT_EQUAL(words.size(), 3u);
+    ASSERT_EQUAL(copy.size(), 4u);
+}
+
+TEST(test_move) {
+    Map<std::string, double> words;
+    words["hello"] = 1;
+    words["world"] = 2;
+
+    Map<std::string, double> moved(std::move(words));
+    ASSERT_TRUE(words.empty());
+    ASSERT_EQUAL(moved.size(), 2u);
+
+    words = std::move(moved);
+    ASSERT_TRUE(moved.empty());
+    ASSERT_EQUAL(words["world"], 2);
+
+    // inserting an rvalue pair
+    std::pair<std::string, double> big(std::string(100, 'x'), 3);
+    ASSERT_TRUE(words.insert(std::move(big)).second);
+    ASSERT_EQUAL(words[std::string(100, 'x')], 3);
+}
+
+TEST(test_extract) {
+    Map<std::string, double> euchre;
+    Map<std::string, double> calculator;
+    euchre["card"] = 3;
+    euchre["stack"] = 1;
+
+    Map<std::string, double>::Node_handle handle = euchre.extract("stack");
+    ASSERT_FALSE(handle.empty());
+    ASSERT_EQUAL(handle.value().first, "stack");
+    handle.value().second = 4;
+
+    auto it = calculator.insert(std::move(handle));
+    ASSERT_TRUE(handle.empty());
+    ASSERT_EQUAL(it->second, 4);
+    ASSERT_EQUAL(euchre.size(), 1u);
+    ASSERT_EQUAL(calculator.size(), 1u);
+
+    ASSERT_TRUE(euchre.extract("missing").empty());
+}
+
+TEST(test_parallel_for_each) {
+    Map<int, double> counts;
+    for (int key = 0; key < 1000; ++key) {
+        counts[key] = key;
+    }
+
+    ThreadPool pool(4);
+    counts.parallel_for_each([](std::pair<int, double> &p) {
+        p.second = 2 * p.second + 1;
+    }, pool);
+
+    for (auto &p : counts) {
+        ASSERT_EQUAL(p.second, 2.0 * p.first + 1);
+    }
+}
+
+TEST(test_parallel_reduce) {
+    Map<std::string, int> words;
+    std::string expected;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        words[std::string(1, c)] = c - 'a';
+        expected += c;
+    }
+
+    ThreadPool pool(4);
+
+    // concatenation is not commutative, so this checks the order
+    std::string keys = words.parallel_reduce(std::string(),
+        [](const std::pair<std::string, int> &p) { return p.first; },
+        [](const std::string &a, const std::string &b) { return a + b; },
+        pool);
+    ASSERT_EQUAL(keys, expected);
+
+    // reducing needs only const access
+    const Map<std::string, int> &view = words;
+    int sum = view.parallel_reduce(0,
+        [](const std::pair<std::string, int> &p) { return p.second; },
+        std::plus<int>(), pool);
+    ASSERT_EQUAL(sum, 25 * 26 / 2);
+
+    // an empty Map reduces to the identity
+    Map<std::string, int> empty;
+    ASSERT_EQUAL(empty.parallel_reduce(7,
+        [](const std::pair<std::string, int> &p) { return p.second; },
+        std::plus<int>(), pool), 7);
+}
+
+TEST_MAIN()
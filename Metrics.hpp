@@ -0,0 +1,321 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+/* Metrics.hpp
+ *
+ * Evaluating the predictions of a Model on labeled posts. A
+ * Confusion_matrix counts how often each correct label was predicted as
+ * each label, and from those counts gives the precision, recall and F1
+ * score of every label and their macro and micro averages.
+ *
+ * Counting is done in parallel: every thread counts its share of the
+ * posts into a matrix of its own, and the partial matrices are merged
+ * at the end, so no thread waits on another while counting. The counts
+ * are whole numbers, so the result is the same for any number of threads.
+ */
+
+#include "Model.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>   //max
+#include <ostream>     //ostream
+#include <string>      //string, to_string
+#include <string_view> //string_view
+#include <utility>     //pair
+#include <vector>      //vector
+
+// The precision, recall and F1 score of a label, or an average of them.
+// A ratio whose denominator is 0 is 0.
+struct Label_metrics {
+  double precision;
+  double recall;
+  double f1;
+  // the number of posts with the label as their correct label
+  int support;
+};
+
+class Confusion_matrix {
+public:
+  // EFFECTS : Creates an empty matrix for the labels 0 .. label_count - 1.
+  //           Correct labels may also be label_count, the unknown label ID
+  //           of a Vocabulary, for posts whose label the Model never saw.
+  //           A Model with no labels predicts the unknown label ID too.
+  explicit Confusion_matrix(int label_count = 0)
+    : label_count(label_count),
+      counts((label_count + 1) * (label_count + 1), 0) { }
+
+  // REQUIRES: 0 <= correct <= label_count and 0 <= predicted <= label_count
+  // MODIFIES: this
+  // EFFECTS : Counts one post with the correct label that was predicted to
+  //           have the predicted label.
+  void add(int correct, int predicted) {
+    counts[correct * (label_count + 1) + predicted] += 1;
+  }
+
+  // REQUIRES: other has the same labels as this
+  // MODIFIES: this
+  // EFFECTS : Adds the counts of other to this.
+  void merge(const Confusion_matrix &other) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += other.counts[i];
+    }
+  }
+
+  // EFFECTS : Returns the confusion matrix of predictions[i] against the
+  //           correct label of posts[i] for every i, with labels giving
+  //           the IDs of the labels. Each thread of pool counts a share of
+  //           the posts into a matrix of its own, and these are merged.
+  static Confusion_matrix count(
+    const Vocabulary &labels,
+    const std::vector<std::pair<std::string, std::string>> &posts,
+    const std::vector<Prediction> &predictions, ThreadPool &pool) {
+    size_t shards = pool.size();
+    std::vector<Confusion_matrix> parts(shards,
+                                        Confusion_matrix(labels.size()));
+    pool.run(shards, [&](size_t shard) {
+      size_t end = posts.size() * (shard + 1) / shards;
+      for (size_t i = posts.size() * shard / shards; i < end; ++i) {
+        parts[shard].add(labels.get_id(posts[i].first),
+                         predictions[i].label);
+      }
+    });
+    pool.reduce(parts, [](Confusion_matrix &into,
+                          const Confusion_matrix &from) {
+      into.merge(from);
+    });
+    return parts[0];
+  }
+
+  int get_label_count() const {
+    return label_count;
+  }
+
+  // EFFECTS : Returns how many posts with the correct label were
+  //           predicted to have the predicted label.
+  int get_count(int correct, int predicted) const {
+    return counts[correct * (label_count + 1) + predicted];
+  }
+
+  // EFFECTS : Returns the number of posts counted.
+  int get_total() const {
+    int total = 0;
+    for (int count : counts) {
+      total += count;
+    }
+    return total;
+  }
+
+  // EFFECTS : Returns whether any post has a correct label the Model never
+  //           saw, counted in the row of the unknown label ID.
+  bool has_unknown_labels() const {
+    return get_support(label_count) > 0;
+  }
+
+  // EFFECTS : Returns whether any post was predicted to have the unknown
+  //           label ID, counted in its column.
+  bool has_unknown_predictions() const {
+    return get_predicted(label_count) > 0;
+  }
+
+  // REQUIRES: 0 <= label <= label_count
+  // EFFECTS : Returns the metrics of label: the fraction of the posts
+  //           predicted to have it that do, and of those that do that are
+  //           predicted to, and their harmonic mean.
+  Label_metrics get_metrics(int label) const {
+    int true_positives = label < label_count ? get_count(label, label) : 0;
+    return make_metrics(true_positives, get_predicted(label),
+                        get_support(label));
+  }
+
+  // EFFECTS : Returns the unweighted mean of the precision, recall and F1
+  //           score of every label, including the unknown label if any
+  //           post has it, and the total support.
+  Label_metrics get_macro_average() const {
+    int classes = label_count + has_unknown_labels();
+    Label_metrics average = { 0, 0, 0, 0 };
+    for (int label = 0; label < classes; ++label) {
+      Label_metrics metrics = get_metrics(label);
+      average.precision += metrics.precision / classes;
+      average.recall += metrics.recall / classes;
+      average.f1 += metrics.f1 / classes;
+      average.support += metrics.support;
+    }
+    return average;
+  }
+
+  // EFFECTS : Returns the metrics of the pooled counts of every label.
+  //           With one label per post, the micro precision and recall are
+  //           both the accuracy.
+  Label_metrics get_micro_average() const {
+    int correct = 0;
+    for (int label = 0; label < label_count; ++label) {
+      correct += get_count(label, label);
+    }
+    return make_metrics(correct, get_total(), get_total());
+  }
+
+  // EFFECTS : Prints the matrix, with a row per correct label and a
+  //           column per predicted label, then the metrics of every label
+  //           and their averages.
+  void print_text(std::ostream &os, const Vocabulary &labels) const {
+    os << "confusion matrix (rows are correct labels, columns predicted):"
+       << std::endl;
+    os << "  " << pad("", name_width(labels));
+    for (int predicted = 0; predicted < columns(); ++predicted) {
+      os << ' ' << pad_left(label_name(labels, predicted),
+                            column_width(labels));
+    }
+    os << std::endl;
+    for (int correct = 0; correct < rows(); ++correct) {
+      os << "  " << pad(label_name(labels, correct), name_width(labels));
+      for (int predicted = 0; predicted < columns(); ++predicted) {
+        os << ' ' << pad_left(std::to_string(get_count(correct, predicted)),
+                              column_width(labels));
+      }
+      os << std::endl;
+    }
+
+    os << "metrics by label:" << std::endl;
+    for (int label = 0; label < rows(); ++label) {
+      print_metrics(os, "  " + pad(std::string(label_name(labels, label))
+                                   + ":", name_width(labels) + 1),
+                    get_metrics(label));
+    }
+    print_metrics(os, "macro average:", get_macro_average());
+    print_metrics(os, "micro average:", get_micro_average());
+  }
+
+  // EFFECTS : Prints the same as print_text as one CSV table: a row per
+  //           correct label with its support, metrics and the counts of
+  //           every predicted label, then a row for each average.
+  void print_csv(std::ostream &os, const Vocabulary &labels) const {
+    os << "label,support,precision,recall,f1";
+    for (int predicted = 0; predicted < columns(); ++predicted) {
+      os << ',' << csv_field(label_name(labels, predicted));
+    }
+    os << '\n';
+    for (int label = 0; label < rows(); ++label) {
+      print_csv_row(os, label_name(labels, label), get_metrics(label));
+      for (int predicted = 0; predicted < columns(); ++predicted) {
+        os << ',' << get_count(label, predicted);
+      }
+      os << '\n';
+    }
+    print_csv_row(os, "macro average", get_macro_average());
+    os << std::string(columns(), ',') << '\n';
+    print_csv_row(os, "micro average", get_micro_average());
+    os << std::string(columns(), ',') << '\n';
+  }
+
+private:
+  int label_count;
+  // at [correct * (label_count + 1) + predicted], with a last row and
+  // column for the unknown label ID
+  std::vector<int> counts;
+
+  // EFFECTS : Returns the number of rows to show: one per label, and one
+  //           for the unknown label if any post has it.
+  int rows() const {
+    return label_count + has_unknown_labels();
+  }
+
+  // EFFECTS : Returns the number of columns to show: one per label, and
+  //           one for the unknown label if any post was predicted to have
+  //           it.
+  int columns() const {
+    return label_count + has_unknown_predictions();
+  }
+
+  int get_support(int label) const {
+    int support = 0;
+    for (int predicted = 0; predicted <= label_count; ++predicted) {
+      support += get_count(label, predicted);
+    }
+    return support;
+  }
+
+  int get_predicted(int label) const {
+    int predicted = 0;
+    for (int correct = 0; correct <= label_count; ++correct) {
+      predicted += get_count(correct, label);
+    }
+    return predicted;
+  }
+
+  static Label_metrics make_metrics(int true_positives, int predicted,
+                                    int support) {
+    Label_metrics metrics;
+    metrics.precision = ratio(true_positives, predicted);
+    metrics.recall = ratio(true_positives, support);
+    metrics.f1 = ratio(2 * metrics.precision * metrics.recall,
+                       metrics.precision + metrics.recall);
+    metrics.support = support;
+    return metrics;
+  }
+
+  static double ratio(double numerator, double denominator) {
+    return denominator > 0 ? numerator / denominator : 0;
+  }
+
+  std::string_view label_name(const Vocabulary &labels, int label) const {
+    return label < label_count ? labels.get_string(label) : "(unknown)";
+  }
+
+  // EFFECTS : Returns the width of the longest row name.
+  int name_width(const Vocabulary &labels) const {
+    size_t width = 0;
+    for (int label = 0; label < rows(); ++label) {
+      width = std::max(width, label_name(labels, label).size());
+    }
+    return width;
+  }
+
+  // EFFECTS : Returns the width of the widest column heading or count.
+  int column_width(const Vocabulary &labels) const {
+    size_t width = std::to_string(get_total()).size();
+    for (int label = 0; label < columns(); ++label) {
+      width = std::max(width, label_name(labels, label).size());
+    }
+    return width;
+  }
+
+  static std::string pad(std::string_view text, size_t width) {
+    std::string padded(text);
+    padded.resize(std::max(width, text.size()), ' ');
+    return padded;
+  }
+
+  static std::string pad_left(std::string_view text, size_t width) {
+    return std::string(width - std::min(width, text.size()), ' ')
+           + std::string(text);
+  }
+
+  static void print_metrics(std::ostream &os, const std::string &name,
+                            const Label_metrics &metrics) {
+    os << name << " precision = " << metrics.precision
+       << ", recall = " << metrics.recall << ", F1 = " << metrics.f1
+       << ", support = " << metrics.support << std::endl;
+  }
+
+  static void print_csv_row(std::ostream &os, std::string_view name,
+                            const Label_metrics &metrics) {
+    os << csv_field(name) << ',' << metrics.support << ','
+       << metrics.precision << ',' << metrics.recall << ',' << metrics.f1;
+  }
+
+  // EFFECTS : Returns text as a CSV field, quoted if it has a comma, a
+  //           quote or a line break, with its quotes doubled.
+  static std::string csv_field(std::string_view text) {
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+      return std::string(text);
+    }
+    std::string field = "\"";
+    for (char c : text) {
+      if (c == '"') {
+        field += '"';
+      }
+      field += c;
+    }
+    return field + '"';
+  }
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,1740 @@
+#ifndef MODEL_HPP
+#define MODEL_HPP
+/* Model.hpp
+ *
+ * The trained naive Bayes classifier: the Vocabulary that interns words
+ * and labels, the training counts in Data, and the log-probability
+ * tables in Model. Tokenizer splits posts into word IDs for scoring.
+ */
+
+#include "ThreadPool.hpp"
+#include <algorithm>     //sort, unique, merge, heaps
+#include <cmath>         //log
+#include <cstdint>       //uint32_t, uint64_t, UINT32_MAX
+#include <cstring>       //memcpy
+#include <memory>        //shared_ptr
+#include <iterator>      //back_inserter
+#include <string>        //string
+#include <string_view>   //string_view
+#include <utility>       //pair
+#include <vector>        //vector
+
+// The AVX2 scoring kernel needs GCC or Clang on x86; other builds use
+// only the portable kernel.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MODEL_HAS_AVX2
+#include <immintrin.h>   //AVX2 intrinsics
+#endif
+
+// The tokenizer scans for whitespace 16 bytes at a time with SSE2, which
+// every x86-64 CPU has; other builds scan a byte at a time.
+#if defined(__SSE2__)
+#define MODEL_HAS_SSE2
+#include <emmintrin.h>   //SSE2 intrinsics
+#endif
+
+// Interns a set of strings as dense integer IDs 0 .. size() - 1.
+// IDs follow the sorted order of the strings they were created with, so
+// visiting IDs in increasing order visits the strings in the same order
+// as a std::set. Strings added later get the next IDs in the order they
+// are added.
+//
+// The strings and an open-addressing hash table of their IDs are kept in
+// flat arrays. A Vocabulary either owns these arrays or is a view of
+// arrays owned elsewhere, such as another Vocabulary or a mapped model
+// file.
+//
+// A hashed Vocabulary, made by hashed(), keeps no strings at all: it has
+// 2^bits IDs, one per hash bucket, and every string gets the ID of its
+// bucket, so its size is fixed however many strings it meets and no
+// string is unknown. Different strings may share an ID.
+//
+// A Vocabulary of words also records how Tokenizer should split posts
+// for it: the longest n-grams to extract, as its ngram order, and whether
+// repeated words are kept and counted, as a multinomial model needs,
+// rather than only noted as present.
+class Vocabulary
+{
+private:
+    static constexpr uint32_t empty_slot = UINT32_MAX;
+
+    // the arrays of an owning Vocabulary; empty in a view
+    std::vector<uint64_t> offset_storage;
+    std::vector<char> char_storage;
+    std::vector<uint32_t> slot_storage;
+
+    int count;
+    // string i is chars[offsets[i]] .. chars[offsets[i + 1]]
+    const uint64_t *offsets;
+    const char *chars;
+    // IDs by hash of their string, or empty_slot; slot_count is a power
+    // of two
+    const uint32_t *slots;
+    uint64_t slot_count;
+    // log2 of the number of buckets of a hashed Vocabulary, else 0
+    int hash_bits;
+    int ngram_order;
+    bool term_counts;
+
+public:
+    // constructors
+    Vocabulary()
+    : Vocabulary(std::vector<std::string_view>()) { }
+
+    // REQUIRES: sorted_strings is sorted and free of duplicates
+    Vocabulary(const std::vector<std::string_view> &sorted_strings)
+    : count(sorted_strings.size()), slot_count(1), hash_bits(0), 
+      ngram_order(1), term_counts(false)
+    {
+        offset_storage.push_back(0);
+        for (std::string_view str : sorted_strings) {
+            char_storage.insert(char_storage.end(), str.begin(), str.end());
+            offset_storage.push_back(char_storage.size());
+        }
+        offsets = offset_storage.data();
+        chars = char_storage.data();
+        build_slots();
+    }
+
+    // REQUIRES: the arrays are laid out as in an owning Vocabulary and
+    //           outlive this one
+    // EFFECTS: Creates a view of the given arrays.
+    Vocabulary(int count, const uint64_t *offsets, const char *chars, 
+               const uint32_t *slots, uint64_t slot_count)
+    : count(count), offsets(offsets), chars(chars), slots(slots), 
+      slot_count(slot_count), hash_bits(0), ngram_order(1), 
+      term_counts(false) { }
+
+    // REQUIRES: 0 < bits < 31
+    // EFFECTS: Returns a hashed Vocabulary of 2^bits buckets.
+    static Vocabulary hashed(int bits)
+    {
+        Vocabulary vocabulary(1 << bits, nullptr, nullptr, nullptr, 0);
+        vocabulary.hash_bits = bits;
+        return vocabulary;
+    }
+
+    // Moving keeps the arrays in place, so views of the source stay valid.
+    Vocabulary(Vocabulary &&other) = default;
+    Vocabulary & operator=(Vocabulary &&other) = default;
+
+    // EFFECTS: Returns a view of this Vocabulary, which is valid while
+    //          this one is.
+    Vocabulary view() const
+    {
+        Vocabulary result(count, offsets, chars, slots, slot_count);
+        result.hash_bits = hash_bits;
+        result.ngram_order = ngram_order;
+        result.term_counts = term_counts;
+        return result;
+    }
+
+    // REQUIRES: this Vocabulary owns its arrays, is not hashed, and str is
+    //           not in it
+    // MODIFIES: this
+    // EFFECTS: Adds str with the next ID, size() before the call, and
+    //          returns that ID. Views of this Vocabulary become invalid.
+    int add(std::string_view str)
+    {
+        char_storage.insert(char_storage.end(), str.begin(), str.end());
+        offset_storage.push_back(char_storage.size());
+        offsets = offset_storage.data();
+        chars = char_storage.data();
+        ++count;
+        if (2 * uint64_t(count) > slot_count) {
+            build_slots();
+        }
+        else {
+            slot_storage[find_slot(str)] = count - 1;
+        }
+        return count - 1;
+    }
+
+    // accessors
+    int size() const
+    {
+        return count;
+    }
+
+    // EFFECTS: Returns the ID of str, or get_unknown_id() if str is not
+    //          in the vocabulary. In a hashed Vocabulary, returns the ID of
+    //          the bucket of str: the top hash_bits bits of its hash, mixed
+    //          by a Fibonacci multiplier so every bit of the hash counts.
+    int get_id(std::string_view str) const
+    {
+        if (hash_bits > 0) {
+            return (hash(str) * 11400714819323198485ull) >> (64 - hash_bits);
+        }
+        uint32_t id = slots[find_slot(str)];
+        return id == empty_slot ? get_unknown_id() : id;
+    }
+
+    // EFFECTS: Returns the ID given to strings outside the vocabulary,
+    //          which is one past the last real ID.
+    int get_unknown_id() const
+    {
+        return size();
+    }
+
+    // EFFECTS: Returns the string with the given ID; empty for the
+    //          buckets of a hashed Vocabulary, which keeps no strings, and
+    //          for the unknown ID.
+    std::string_view get_string(int id) const
+    {
+        if (hash_bits > 0 || id == get_unknown_id()) {
+            return std::string_view();
+        }
+        return std::string_view(chars + offsets[id], 
+                                offsets[id + 1] - offsets[id]);
+    }
+
+    // EFFECTS: Returns log2 of the number of buckets of a hashed
+    //          Vocabulary, or 0 if it is not hashed.
+    int get_hash_bits() const
+    {
+        return hash_bits;
+    }
+
+    // EFFECTS: Returns the longest n-grams Tokenizer extracts for this
+    //          Vocabulary; 1 for single words only.
+    int get_ngram_order() const
+    {
+        return ngram_order;
+    }
+
+    // REQUIRES: order > 0
+    // MODIFIES: this
+    void set_ngram_order(int order)
+    {
+        ngram_order = order;
+    }
+
+    // EFFECTS: Returns whether Tokenizer counts how often each word of a
+    //          post occurs for this Vocabulary, instead of only which
+    //          words occur.
+    bool has_term_counts() const
+    {
+        return term_counts;
+    }
+
+    // MODIFIES: this
+    void set_term_counts(bool counts)
+    {
+        term_counts = counts;
+    }
+
+    // EFFECTS: Returns the 64-bit FNV-1a hash of str. Unlike std::hash it
+    //          is the same in every build, so saved tables stay valid.
+    static uint64_t hash(std::string_view str)
+    {
+        uint64_t result = 14695981039346656037ull;
+        for (char c : str) {
+            result = (result ^ (unsigned char)c) * 1099511628211ull;
+        }
+        return result;
+    }
+
+    // MODIFIES: ids
+    // EFFECTS: Removes duplicate IDs, which a hashed Vocabulary gives
+    //          strings that share a bucket, so that a post counts and
+    //          scores each bucket once. The IDs of a Vocabulary that is not
+    //          hashed are left as they are.
+    void remove_collisions(std::vector<int> &ids) const
+    {
+        if (hash_bits > 0) {
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+    }
+
+    // raw arrays, for saving; none in a hashed Vocabulary
+    const uint64_t * get_offsets() const
+    {
+        return offsets;
+    }
+
+    const char * get_chars() const
+    {
+        return chars;
+    }
+
+    const uint32_t * get_slots() const
+    {
+        return slots;
+    }
+
+    uint64_t get_slot_count() const
+    {
+        return slot_count;
+    }
+
+private:
+    // MODIFIES: this
+    // EFFECTS: Rebuilds the hash table of an owning Vocabulary, sized so
+    //          that it is at most half full and probe sequences stay short.
+    void build_slots()
+    {
+        slot_count = 1;
+        while (slot_count < 2 * uint64_t(count)) {
+            slot_count *= 2;
+        }
+        slot_storage.assign(slot_count, empty_slot);
+        slots = slot_storage.data();
+        for (int id = 0; id < count; ++id) {
+            slot_storage[find_slot(get_string(id))] = id;
+        }
+    }
+
+    // EFFECTS: Returns the slot holding the ID of str, or the empty slot
+    //          where it would go.
+    uint64_t find_slot(std::string_view str) const
+    {
+        uint64_t slot = hash(str) & (slot_count - 1);
+        while (slots[slot] != empty_slot && get_string(slots[slot]) != str) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        return slot;
+    }
+};
+
+// MODIFIES: ids, counts
+// EFFECTS: Turns the IDs of the words of a post, one per occurrence, into
+//          a histogram: sorts ids, then shortens every run of equal IDs to
+//          one, setting counts[i] to the length of the run of ids[i].
+inline void count_runs(std::vector<int> &ids, std::vector<int> &counts)
+{
+    std::sort(ids.begin(), ids.end());
+    counts.clear();
+    size_t unique = 0;
+    for (size_t i = 0; i < ids.size(); ) {
+        size_t run = 1;
+        while (i + run < ids.size() && ids[i + run] == ids[i]) {
+            ++run;
+        }
+        ids[unique++] = ids[i];
+        counts.push_back(run);
+        i += run;
+    }
+    ids.resize(unique);
+}
+
+// The label and unique words of every training post, or every word with
+// its repeats for term counts, as views of the strings they were read
+// from. Those strings only need to outlive the Data constructor, which
+// copies what it keeps.
+using Posts = std::vector<std::pair<std::string_view, 
+                                    std::vector<std::string_view>>>;
+
+// How the words of posts are turned into features
+struct Features
+{
+    // if positive, words are counted in the 2^hash_bits buckets of a
+    // hashed Vocabulary instead of one by one, so the counts take a fixed
+    // amount of memory however many words the posts have
+    int hash_bits = 0;
+    // n-grams of up to this many words are features too
+    int ngram_order = 1;
+    // count how often each word occurs in a post, for a multinomial
+    // model, instead of only whether it occurs
+    bool term_counts = false;
+};
+
+class Data
+{
+private:
+    int post_count;
+    Vocabulary words;
+    Vocabulary labels;
+    // counts indexed by ID; label-word counts are word-major,
+    // at [word * labels.size() + label]
+    std::vector<double> post_label_word_frequency;
+    std::vector<double> post_label_frequency;
+    std::vector<double> post_word_frequency;
+    // with term counts, the words of the posts of each label, and of all
+    // posts, counting repeats
+    std::vector<double> post_label_token_count;
+    double token_count;
+    // see get_seen_word_count
+    int seen_word_count;
+
+    // changes since the last clear_changes(), for updating a Model: which
+    // labels gained posts, and whether any post was observed at all
+    std::vector<bool> changed_labels;
+    bool changed;
+
+    // The counts of one shard of the training posts
+    struct Counts
+    {
+        std::vector<double> label_word;
+        std::vector<double> label;
+        std::vector<double> word;
+        std::vector<double> label_tokens;
+        // scratch space for the word IDs of one post and their counts
+        std::vector<int> word_ids;
+        std::vector<int> word_counts;
+
+        void add(const Counts &other)
+        {
+            add(label_word, other.label_word);
+            add(label, other.label);
+            add(word, other.word);
+            add(label_tokens, other.label_tokens);
+        }
+
+        void subtract(const Counts &other)
+        {
+            subtract(label_word, other.label_word);
+            subtract(label, other.label);
+            subtract(word, other.word);
+            subtract(label_tokens, other.label_tokens);
+        }
+
+        static void add(std::vector<double> &into, 
+                        const std::vector<double> &from)
+        {
+            for (size_t i = 0; i < into.size(); ++i) {
+                into[i] += from[i];
+            }
+        }
+
+        static void subtract(std::vector<double> &into, 
+                             const std::vector<double> &from)
+        {
+            for (size_t i = 0; i < into.size(); ++i) {
+                into[i] -= from[i];
+            }
+        }
+    };
+
+    // constructor for cross-validation: counts over views of the
+    // vocabularies of total
+    Data(const Data &total, int post_count, Counts counts)
+    : post_count(post_count), words(total.words.view()), 
+      labels(total.labels.view()), 
+      post_label_word_frequency(std::move(counts.label_word)), 
+      post_label_frequency(std::move(counts.label)), 
+      post_word_frequency(std::move(counts.word)), 
+      post_label_token_count(std::move(counts.label_tokens)), 
+      token_count(sum(post_label_token_count)), 
+      seen_word_count(count_seen_words()), 
+      changed_labels(labels.size(), false), changed(false) { }
+
+public:
+    // constructors
+    // The ngram order and term counts of features are recorded in the
+    // word Vocabulary; the words of the posts must be those Tokenizer
+    // extracts for it.
+    Data(const Posts &data_vector, const Features &features = Features())
+    : post_count(data_vector.size()), changed(false)
+    {
+        ThreadPool pool(1);
+        set_vocabularies(data_vector, pool, features);
+        count_label_word_frequency(data_vector, pool);
+    }
+
+    // EFFECTS: Counts the training posts in parallel on the given pool.
+    //          Each thread counts one shard of the posts into its own
+    //          tables, and the tables are then summed, so the counts are
+    //          the same for any number of threads.
+    Data(const Posts &data_vector, ThreadPool &pool, 
+         const Features &features = Features())
+    : post_count(data_vector.size()), changed(false)
+    {
+        set_vocabularies(data_vector, pool, features);
+        count_label_word_frequency(data_vector, pool);
+    }
+
+    // data mutators
+    void set_vocabularies(const Posts &data_vector, ThreadPool &pool, 
+                          const Features &features = Features())
+    {
+        int hash_bits = features.hash_bits;
+        size_t shards = pool.size();
+        std::vector<std::vector<std::string_view>> shard_words(shards);
+        std::vector<std::vector<std::string_view>> shard_labels(shards);
+        pool.run(shards, [&](size_t shard) {
+            std::vector<std::string_view> &unique_words = shard_words[shard];
+            std::vector<std::string_view> &unique_labels = shard_labels[shard];
+            for (size_t i = shard_begin(data_vector, shards, shard); 
+                 i < shard_begin(data_vector, shards, shard + 1); ++i) {
+                unique_labels.push_back(data_vector[i].first);
+                if (hash_bits == 0) {
+                    unique_words.insert(unique_words.end(), 
+                                        data_vector[i].second.begin(), 
+                                        data_vector[i].second.end());
+                }
+            }
+            sort_unique(unique_words);
+            sort_unique(unique_labels);
+        });
+        pool.reduce(shard_words, merge_sorted);
+        pool.reduce(shard_labels, merge_sorted);
+        words = hash_bits > 0 ? Vocabulary::hashed(hash_bits) 
+                              : Vocabulary(shard_words[0]);
+        words.set_ngram_order(features.ngram_order);
+        words.set_term_counts(features.term_counts);
+        labels = Vocabulary(shard_labels[0]);
+    }
+
+    void count_label_word_frequency(const Posts &data_vector, ThreadPool &pool)
+    {
+        size_t shards = pool.size();
+        std::vector<Counts> shard_counts(shards);
+        pool.run(shards, [&](size_t shard) {
+            Counts &counts = shard_counts[shard];
+            clear_counts(counts);
+            for (size_t i = shard_begin(data_vector, shards, shard); 
+                 i < shard_begin(data_vector, shards, shard + 1); ++i) {
+                count_post(counts, data_vector[i]);
+            }
+        });
+        // counts are whole numbers, so summing them in any order is exact
+        pool.reduce(shard_counts, [](Counts &into, const Counts &from) {
+            into.add(from);
+        });
+        post_label_word_frequency = std::move(shard_counts[0].label_word);
+        post_label_frequency = std::move(shard_counts[0].label);
+        post_word_frequency = std::move(shard_counts[0].word);
+        post_label_token_count = std::move(shard_counts[0].label_tokens);
+        token_count = sum(post_label_token_count);
+        seen_word_count = count_seen_words();
+        changed_labels.assign(labels.size(), false);
+    }
+
+    // REQUIRES: data_vector is the posts this Data was built from, and
+    //          fold_count > 1
+    // EFFECTS: Splits the posts into fold_count folds, post i going to
+    //          fold i % fold_count, and returns for every fold the Data of
+    //          training on the other folds. The counts of each fold are
+    //          found once, in parallel on pool, and subtracted from the
+    //          counts of this Data. The results share the vocabularies of
+    //          this Data, which must outlive them and not observe posts
+    //          meanwhile; a word seen only in the held-out fold has a
+    //          count of 0 there, which Model treats as an unknown word, and
+    //          is left out of get_seen_word_count, so that a Model of a
+    //          fold has the log-likelihoods of training on its posts alone.
+    std::vector<Data> get_folds(const Posts &data_vector, size_t fold_count, 
+                                ThreadPool &pool) const
+    {
+        std::vector<Counts> fold_counts(fold_count);
+        std::vector<int> fold_post_counts(fold_count, 0);
+        pool.run(fold_count, [&](size_t fold) {
+            Counts counts;
+            clear_counts(counts);
+            for (size_t i = fold; i < data_vector.size(); i += fold_count) {
+                count_post(counts, data_vector[i]);
+                ++fold_post_counts[fold];
+            }
+            // the counts of training on every other fold
+            fold_counts[fold].label_word = post_label_word_frequency;
+            fold_counts[fold].label = post_label_frequency;
+            fold_counts[fold].word = post_word_frequency;
+            fold_counts[fold].label_tokens = post_label_token_count;
+            fold_counts[fold].subtract(counts);
+        });
+
+        std::vector<Data> folds;
+        for (size_t fold = 0; fold < fold_count; ++fold) {
+            folds.push_back(Data(*this, post_count - fold_post_counts[fold], 
+                                 std::move(fold_counts[fold])));
+        }
+        return folds;
+    }
+
+    // REQUIRES: words is free of duplicates, unless the word Vocabulary
+    //           has term counts
+    // MODIFIES: this
+    // EFFECTS: Counts one more training post, adding its label and words
+    //          to the vocabularies if they are new. The post is recorded as
+    //          a change until clear_changes() is called. Views of the
+    //          vocabularies, including those held by a Model, are invalid
+    //          until Model::update is called.
+    void observe(std::string_view label, 
+                 const std::vector<std::string_view> &words)
+    {
+        int label_id = labels.get_id(label);
+        if (label_id == labels.get_unknown_id()) {
+            label_id = add_label(label);
+        }
+        ++post_count;
+        post_label_frequency[label_id] += 1;
+        std::vector<int> word_ids;
+        for (std::string_view word : words) {
+            int word_id = this->words.get_id(word);
+            if (word_id == this->words.get_unknown_id()) {
+                word_id = this->words.add(word);
+                ++seen_word_count;
+                post_word_frequency.push_back(0);
+                post_label_word_frequency.resize(
+                    post_label_word_frequency.size() + labels.size(), 0);
+            }
+            word_ids.push_back(word_id);
+        }
+        if (this->words.has_term_counts()) {
+            token_count += word_ids.size();
+        }
+        std::vector<int> word_counts;
+        count_words(label_id, word_ids, word_counts, post_label_word_frequency, 
+                    post_word_frequency, post_label_token_count);
+        changed_labels[label_id] = true;
+        changed = true;
+    }
+
+    // MODIFIES: this
+    // EFFECTS: Forgets the changes recorded by observe.
+    void clear_changes()
+    {
+        changed_labels.assign(labels.size(), false);
+        changed = false;
+    }
+
+    // accessors
+    int get_post_count() const
+    {
+        return post_count;
+    }
+
+    const Vocabulary & get_words() const
+    {
+        return words;
+    }
+
+    const Vocabulary & get_labels() const
+    {
+        return labels;
+    }
+
+    double get_label_word_frequency(int label, int word) const
+    {
+        return post_label_word_frequency[word * labels.size() + label];
+    }
+
+    double get_label_frequency(int label) const
+    {
+        return post_label_frequency[label];
+    }
+
+    double get_word_frequency(int word) const
+    {
+        return post_word_frequency[word];
+    }
+
+    // EFFECTS: Returns the number of words that occur in the posts of this
+    //          Data, the vocabulary size of training on them alone; for a
+    //          hashed Vocabulary, its number of buckets. Only the Data of a
+    //          fold has fewer than its Vocabulary, which it shares with
+    //          the Data of every post.
+    int get_seen_word_count() const
+    {
+        return seen_word_count;
+    }
+
+    // EFFECTS: Returns what the likelihoods of words given the label are
+    //          relative to: the number of posts with the label, or with
+    //          term counts the number of words in them, counting repeats.
+    double get_label_total(int label) const
+    {
+        return words.has_term_counts() ? post_label_token_count[label] 
+                                       : post_label_frequency[label];
+    }
+
+    // EFFECTS: Returns the number of posts, or with term counts the number
+    //          of words in them, counting repeats.
+    double get_total() const
+    {
+        return words.has_term_counts() ? token_count : post_count;
+    }
+
+    // EFFECTS: Returns whether any post was observed since the last call
+    //          to clear_changes().
+    bool has_changes() const
+    {
+        return changed;
+    }
+
+    // EFFECTS: Returns whether a post with the given label was observed
+    //          since the last call to clear_changes().
+    bool has_changes(int label) const
+    {
+        return changed_labels[label];
+    }
+
+private:
+    // MODIFIES: this
+    // EFFECTS: Adds a label with no posts yet and returns its ID. The
+    //          label-word counts are laid out again for the wider rows.
+    int add_label(std::string_view label)
+    {
+        int old_label_count = labels.size();
+        int label_id = labels.add(label);
+        std::vector<double> label_word(words.size() * labels.size(), 0);
+        for (int word = 0; word < words.size(); ++word) {
+            for (int old_label = 0; old_label < old_label_count; ++old_label) {
+                label_word[word * labels.size() + old_label] = 
+                    post_label_word_frequency[word * old_label_count + old_label];
+            }
+        }
+        post_label_word_frequency = std::move(label_word);
+        post_label_frequency.push_back(0);
+        post_label_token_count.push_back(0);
+        changed_labels.push_back(false);
+        return label_id;
+    }
+
+    // MODIFIES: counts
+    // EFFECTS: Sizes counts for the vocabularies and zeroes them.
+    void clear_counts(Counts &counts) const
+    {
+        counts.label_word.assign(words.size() * labels.size(), 0);
+        counts.label.assign(labels.size(), 0);
+        counts.word.assign(words.size(), 0);
+        counts.label_tokens.assign(labels.size(), 0);
+    }
+
+    // REQUIRES: the label and words of post are in the vocabularies
+    // MODIFIES: counts
+    // EFFECTS: Adds post to counts.
+    void count_post(Counts &counts, const Posts::value_type &post) const
+    {
+        int label = labels.get_id(post.first);
+        counts.label[label] += 1;
+        counts.word_ids.clear();
+        for (std::string_view word : post.second) {
+            counts.word_ids.push_back(words.get_id(word));
+        }
+        count_words(label, counts.word_ids, counts.word_counts, 
+                    counts.label_word, counts.word, counts.label_tokens);
+    }
+
+    // REQUIRES: word_ids has the ID of every word of a post with the given
+    //           label, and label_word, word and label_tokens are sized for
+    //           the vocabularies
+    // MODIFIES: word_ids, word_counts, label_word, word, label_tokens
+    // EFFECTS: Adds the words of the post to the counts. With term counts
+    //          each word adds how often it occurs, found by count_runs;
+    //          otherwise it adds 1 however often it occurs.
+    void count_words(int label, std::vector<int> &word_ids, 
+                     std::vector<int> &word_counts, 
+                     std::vector<double> &label_word, 
+                     std::vector<double> &word, 
+                     std::vector<double> &label_tokens) const
+    {
+        if (words.has_term_counts()) {
+            label_tokens[label] += word_ids.size();
+            count_runs(word_ids, word_counts);
+        }
+        else {
+            words.remove_collisions(word_ids);
+            word_counts.assign(word_ids.size(), 1);
+        }
+        for (size_t i = 0; i < word_ids.size(); ++i) {
+            label_word[word_ids[i] * labels.size() + label] += word_counts[i];
+            word[word_ids[i]] += word_counts[i];
+        }
+    }
+
+    int count_seen_words() const
+    {
+        if (words.get_hash_bits() > 0) {
+            return words.size();
+        }
+        int seen = 0;
+        for (double frequency : post_word_frequency) {
+            seen += frequency > 0;
+        }
+        return seen;
+    }
+
+    static double sum(const std::vector<double> &values)
+    {
+        double total = 0;
+        for (double value : values) {
+            total += value;
+        }
+        return total;
+    }
+
+    // EFFECTS: Returns the index of the first post of the given shard when
+    //          the posts are split into shards of nearly equal size.
+    static size_t shard_begin(const Posts &data_vector, size_t shards, 
+                              size_t shard)
+    {
+        return data_vector.size() * shard / shards;
+    }
+
+    // MODIFIES: strings
+    // EFFECTS: Sorts strings and removes its duplicates.
+    static void sort_unique(std::vector<std::string_view> &strings)
+    {
+        std::sort(strings.begin(), strings.end());
+        strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+    }
+
+    // REQUIRES: into and from are sorted and free of duplicates
+    // MODIFIES: into, from
+    // EFFECTS: Moves the strings of from into into, keeping it sorted and
+    //          free of duplicates.
+    static void merge_sorted(std::vector<std::string_view> &into, 
+                             std::vector<std::string_view> &from)
+    {
+        std::vector<std::string_view> merged;
+        merged.reserve(into.size() + from.size());
+        std::merge(into.begin(), into.end(), from.begin(), from.end(), 
+                   std::back_inserter(merged));
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+        into = std::move(merged);
+        from.clear();
+    }
+};
+
+class Tokenizer;
+
+// The label a Model predicts for a post, with its log-probability score
+struct Prediction
+{
+    int label;
+    double log_probability;
+};
+
+// How much scoring work Model::predict_top_k did, and how much it would
+// have done without pruning
+struct Pruning_stats
+{
+    // log-likelihoods added into label scores
+    uint64_t additions = 0;
+    uint64_t full_additions = 0;
+    // labels abandoned before all their words were added
+    uint64_t pruned_labels = 0;
+    uint64_t labels = 0;
+
+    void add(const Pruning_stats &other)
+    {
+        additions += other.additions;
+        full_additions += other.full_additions;
+        pruned_labels += other.pruned_labels;
+        labels += other.labels;
+    }
+};
+
+// A label whose log-likelihood for a word differs from the word's base
+// log-likelihood, and by how much
+struct Posting
+{
+    int label;
+    double delta;
+};
+
+// A trained model compiled into log-probability tables, so that scoring
+// a post needs only table lookups and additions.
+class Model
+{
+private:
+    // Rows are padded to a whole number of SIMD vectors of this many
+    // doubles. Padding log-likelihoods are 0 and padding priors are -inf,
+    // so padding lanes can be scored with the rest and never win.
+    static constexpr int lanes = 4;
+
+    int post_count;
+    int label_count;
+    // label_count rounded up to a multiple of lanes
+    int label_stride;
+    Vocabulary words;
+    Vocabulary labels;
+    // the additive smoothing of a Model built from Data; see
+    // get_smoothed_log_likelihood
+    double alpha;
+
+    // the tables of a Model built from Data; empty for a loaded Model
+    std::vector<double> prior_storage;
+    std::vector<double> log_likelihood_storage;
+    std::vector<double> max_log_likelihood_storage;
+    // whatever holds the tables of a loaded Model, such as a mapped file
+    std::shared_ptr<const void> external_storage;
+
+    const double *label_log_prior;
+    // word-major log-likelihoods, at [word * label_stride + label]; the row
+    // of the unknown word ID holds log(1 / post_count) for every label
+    const double *log_likelihood;
+    // the largest log-likelihood of each row over all labels, which
+    // bounds what the word can add to the score of any label
+    const double *max_log_likelihood;
+
+    // label IDs from the highest log-prior to the lowest, the order in
+    // which predict_top_k tries them
+    std::vector<int> labels_by_prior;
+
+    // words added to a label's score between checks of its bound
+    static constexpr size_t pruning_interval = 8;
+
+    // The sparse index, built by build_sparse_index. Every entry of a row
+    // is the row's base log-likelihood plus the delta of the label's
+    // posting, or just the base if the label has none; the postings of
+    // word ID w are postings[posting_offsets[w]] .. [posting_offsets[w + 1]].
+    bool has_sparse_index;
+    std::vector<double> base_log_likelihood;
+    std::vector<uint64_t> posting_offsets;
+    std::vector<Posting> postings;
+
+public:
+    // constructor: precomputes every log-probability the classifier uses,
+    // smoothed by alpha
+    // REQUIRES: data outlives this Model, which shares its vocabularies,
+    //           and alpha >= 0
+    Model(const Data *data, double alpha = 0)
+    : post_count(data->get_post_count()), 
+      label_count(data->get_labels().size()), 
+      label_stride(get_label_stride(label_count)), 
+      words(data->get_words().view()), labels(data->get_labels().view()), 
+      alpha(alpha), has_sparse_index(false)
+    {
+        compute_tables(data, 0);
+    }
+
+    // REQUIRES: the tables are laid out as in a Model built from Data
+    // EFFECTS: Creates a Model that reads tables held by storage, which it
+    //          keeps alive.
+    Model(int post_count, Vocabulary words, Vocabulary labels, 
+          const double *label_log_prior, const double *log_likelihood, 
+          const double *max_log_likelihood, 
+          std::shared_ptr<const void> storage)
+    : post_count(post_count), label_count(labels.size()), 
+      label_stride(get_label_stride(label_count)), 
+      words(std::move(words)), labels(std::move(labels)), alpha(0), 
+      external_storage(std::move(storage)), 
+      label_log_prior(label_log_prior), log_likelihood(log_likelihood), 
+      max_log_likelihood(max_log_likelihood), has_sparse_index(false)
+    {
+        order_labels();
+    }
+
+    // Moving keeps the tables in place; copying would not.
+    Model(Model &&other) = default;
+    Model(const Model &other) = delete;
+    Model & operator=(const Model &other) = delete;
+
+    // REQUIRES: this Model was built from data, which has only observed
+    //           more posts since
+    // MODIFIES: this, data
+    // EFFECTS: Brings the tables up to date with the posts data has
+    //          observed since this Model was built or last updated, and
+    //          clears data's changes. Changes are applied in one batch, so
+    //          observe many posts before updating where possible.
+    void update(Data *data)
+    {
+        if (!data->has_changes()) {
+            return;
+        }
+        int first_new_word = words.size();
+        post_count = data->get_post_count();
+        label_count = data->get_labels().size();
+        words = data->get_words().view();
+        labels = data->get_labels().view();
+        if (get_label_stride(label_count) != label_stride) {
+            // every row is laid out again
+            label_stride = get_label_stride(label_count);
+            first_new_word = 0;
+        }
+        if (alpha > 0 && words.has_term_counts() 
+            && words.size() != first_new_word) {
+            // the smoothing of every entry depends on the number of words
+            first_new_word = 0;
+        }
+        compute_tables(data, first_new_word);
+        data->clear_changes();
+        if (has_sparse_index) {
+            build_sparse_index();
+        }
+    }
+
+    // MODIFIES: this
+    // EFFECTS: Builds the index predict_sparse scores with, and keeps it up
+    //          to date through later calls to update. A word's base is the
+    //          log-likelihood most of its row shares, which for a word seen
+    //          in training is the fallback of every label never seen with
+    //          it, so a row has one posting per label that was. The rows
+    //          are indexed in chunks on the threads of pool.
+    void build_sparse_index(ThreadPool &pool)
+    {
+        int row_count = words.size() + 1;
+        const int chunk_size = 256;
+        int chunk_count = (row_count + chunk_size - 1) / chunk_size;
+        base_log_likelihood.assign(row_count, 0);
+        posting_offsets.assign(row_count + 1, 0);
+        // count the postings of every row, then fill them in place
+        for (int pass = 0; pass < 2; ++pass) {
+            pool.run(chunk_count, [&](size_t chunk) {
+                std::vector<double> sorted;
+                int end = std::min<int>(row_count, (chunk + 1) * chunk_size);
+                for (int word = chunk * chunk_size; word < end; ++word) {
+                    const double *row = &log_likelihood[word * label_stride];
+                    if (pass == 0) {
+                        base_log_likelihood[word] = most_common(row, sorted);
+                    }
+                    uint64_t count = 0;
+                    for (int label = 0; label < label_count; ++label) {
+                        if (row[label] != base_log_likelihood[word]) {
+                            if (pass == 1) {
+                                postings[posting_offsets[word] + count] = Posting{ 
+                                    label, row[label] - base_log_likelihood[word] };
+                            }
+                            ++count;
+                        }
+                    }
+                    if (pass == 0) {
+                        posting_offsets[word + 1] = count;
+                    }
+                }
+            });
+            if (pass == 0) {
+                for (int word = 0; word < row_count; ++word) {
+                    posting_offsets[word + 1] += posting_offsets[word];
+                }
+                postings.resize(posting_offsets[row_count]);
+            }
+        }
+        has_sparse_index = true;
+    }
+
+    void build_sparse_index()
+    {
+        ThreadPool pool(1);
+        build_sparse_index(pool);
+    }
+
+    // REQUIRES: word is a word ID of data or its unknown word ID, alpha
+    //           >= 0, and the label has posts or alpha > 0
+    // EFFECTS: Returns the log-likelihood of word given label under the
+    //          counts of data, smoothed by alpha. The counts are of posts,
+    //          or with term counts of words counting repeats; see
+    //          Data::get_label_total. With alpha = 0 a word seen with the
+    //          label gets its frequency in the label's posts, and one that
+    //          was not falls back to its frequency in all posts, or to one
+    //          over their total if no post has it. With alpha > 0 every
+    //          word gets Lidstone smoothing, (label_word + alpha) /
+    //          (label_total + k alpha), where k is the number of outcomes:
+    //          2, present or absent, or with term counts the number of
+    //          words in data's posts, get_seen_word_count.
+    static double get_smoothed_log_likelihood(const Data &data, int label, 
+                                              int word, double alpha)
+    {
+        bool known = word < data.get_words().size();
+        double label_word_frequency = 
+            known ? data.get_label_word_frequency(label, word) : 0;
+        double label_total = data.get_label_total(label);
+        if (alpha > 0) {
+            double outcomes = data.get_words().has_term_counts() 
+                ? data.get_seen_word_count() : 2;
+            return std::log((label_word_frequency + alpha) 
+                            / (label_total + outcomes * alpha));
+        }
+        if (label_word_frequency > 0) {
+            return std::log(label_word_frequency/label_total);
+        }
+        double word_frequency = known ? data.get_word_frequency(word) : 0;
+        if (word_frequency > 0) {
+            return std::log(word_frequency/data.get_total());
+        }
+        return std::log(1.0/data.get_total());
+    }
+
+    // EFFECTS: Returns the row length of the log-likelihood table for a
+    //          Model with the given number of labels.
+    static int get_label_stride(int label_count)
+    {
+        return (label_count + lanes - 1) / lanes * lanes;
+    }
+
+    // accessors
+    int get_post_count() const
+    {
+        return post_count;
+    }
+
+    int get_label_count() const
+    {
+        return label_count;
+    }
+
+    const Vocabulary & get_words() const
+    {
+        return words;
+    }
+
+    const Vocabulary & get_labels() const
+    {
+        return labels;
+    }
+
+    // EFFECTS: Returns the label_stride padded log-priors.
+    const double * get_log_prior_table() const
+    {
+        return label_log_prior;
+    }
+
+    // EFFECTS: Returns the log-likelihood table, including the row of the
+    //          unknown word ID.
+    const double * get_log_likelihood_table() const
+    {
+        return log_likelihood;
+    }
+
+    // EFFECTS: Returns the largest log-likelihood of each row of the
+    //          log-likelihood table, over all labels.
+    const double * get_max_log_likelihood_table() const
+    {
+        return max_log_likelihood;
+    }
+
+    double get_log_prior(int label) const
+    {
+        return label_log_prior[label];
+    }
+
+    // REQUIRES: word is a word ID or the unknown word ID
+    double get_log_likelihood(int label, int word) const
+    {
+        return log_likelihood[word * label_stride + label];
+    }
+
+    // REQUIRES: every element of words is a word ID or the unknown word ID
+    // EFFECTS: Returns the log-probability score of label for a post with
+    //          the given words, adding the log-likelihoods in order.
+    double get_log_probability(int label, const std::vector<int> &words) const
+    {
+        double log_probability = label_log_prior[label];
+        for (int word : words) {
+            log_probability += log_likelihood[word * label_stride + label];
+        }
+        return log_probability;
+    }
+
+    // REQUIRES: every element of words is a word ID or the unknown word ID
+    // MODIFIES: scores
+    // EFFECTS: Returns the label with the highest log-probability score for
+    //          a post with the given words. Ties go to the lowest label ID.
+    //          scores is scratch space, reused to avoid an allocation per
+    //          post. Uses the sparse index once it has been built, and
+    //          otherwise the AVX2 kernel when the CPU supports it. A Model
+    //          trained on no posts has no labels, and predicts label 0,
+    //          the unknown label ID, with a score of -inf.
+    Prediction predict(const std::vector<int> &words, 
+                       std::vector<double> &scores) const
+    {
+        if (has_sparse_index) {
+            return predict_sparse(words, scores);
+        }
+        scores.resize(label_stride);
+#ifdef MODEL_HAS_AVX2
+        if (has_avx2() && label_count > 0) {
+            int label = predict_avx2(words, scores.data());
+            return Prediction{ label, scores[label] };
+        }
+#endif
+        return predict_scalar(words, scores);
+    }
+
+    Prediction predict(const std::vector<int> &words) const
+    {
+        std::vector<double> scores;
+        return predict(words, scores);
+    }
+
+    // REQUIRES: every element of words is a word ID or the unknown word
+    //           ID, and counts[i] > 0 is how often words[i] occurs
+    // MODIFIES: scores
+    // EFFECTS: Same as predict, but adds the log-likelihood of each word
+    //          as many times as it occurs, as a multinomial model does.
+    //          Never uses the sparse index. A count of 1 adds exactly the
+    //          log-likelihood, so with all counts 1 the scores are those
+    //          of predict without the sparse index.
+    Prediction predict(const std::vector<int> &words, 
+                       const std::vector<int> &counts, 
+                       std::vector<double> &scores) const
+    {
+        scores.resize(label_stride);
+#ifdef MODEL_HAS_AVX2
+        if (has_avx2() && label_count > 0) {
+            int label = predict_avx2(words, counts, scores.data());
+            return Prediction{ label, scores[label] };
+        }
+#endif
+        scores.assign(label_log_prior, label_log_prior + label_count);
+        for (size_t i = 0; i < words.size(); ++i) {
+            const double *row = &log_likelihood[words[i] * label_stride];
+            double count = counts[i];
+            for (int label = 0; label < label_count; ++label) {
+                scores[label] += count * row[label];
+            }
+        }
+        return first_best(scores);
+    }
+
+    // MODIFIES: tokenizer, scores
+    // EFFECTS: Returns the prediction for a post with the given content,
+    //          tokenized by tokenizer for the word Vocabulary: by the
+    //          counts of its words if the Vocabulary has term counts, and
+    //          otherwise by predict.
+    Prediction predict_post(Tokenizer &tokenizer, std::string_view content, 
+                            std::vector<double> &scores) const;
+
+    // MODIFIES: scores
+    // EFFECTS: Same as predict, but always uses the portable kernel.
+    Prediction predict_scalar(const std::vector<int> &words, 
+                              std::vector<double> &scores) const
+    {
+        scores.assign(label_log_prior, label_log_prior + label_count);
+        for (int word : words) {
+            const double *row = &log_likelihood[word * label_stride];
+            for (int label = 0; label < label_count; ++label) {
+                scores[label] += row[label];
+            }
+        }
+        return first_best(scores);
+    }
+
+    // REQUIRES: build_sparse_index has been called, and every element of
+    //           words is a word ID or the unknown word ID
+    // MODIFIES: scores
+    // EFFECTS: Same as predict, but scores with the sparse index: the base
+    //          log-likelihoods of the words are summed once for all labels,
+    //          and only the postings of the words are added per label, so
+    //          the work beyond one pass over the labels grows with the
+    //          number of (label, word) pairs seen in training rather than
+    //          with labels times words. The sums are added in a different
+    //          order than by predict, so scores may differ from its scores
+    //          in the last bits, and a near tie may go the other way.
+    Prediction predict_sparse(const std::vector<int> &words, 
+                              std::vector<double> &scores) const
+    {
+        double base = 0;
+        for (int word : words) {
+            base += base_log_likelihood[word];
+        }
+        scores.resize(label_count);
+        for (int label = 0; label < label_count; ++label) {
+            scores[label] = label_log_prior[label] + base;
+        }
+        for (int word : words) {
+            const Posting *first = postings.data() + posting_offsets[word];
+            const Posting *last = postings.data() + posting_offsets[word + 1];
+            for (const Posting *posting = first; posting != last; ++posting) {
+                scores[posting->label] += posting->delta;
+            }
+        }
+        return first_best(scores);
+    }
+
+    // EFFECTS: Returns the number of postings in the sparse index.
+    uint64_t get_posting_count() const
+    {
+        return postings.size();
+    }
+
+    // REQUIRES: every element of words is a word ID or the unknown word ID,
+    //           and k > 0
+    // MODIFIES: stats
+    // EFFECTS: Returns the min(k, label count) labels with the highest
+    //          scores, best first, ranked as by predict and with the same
+    //          scores. Labels are scored one at a time, and a label is
+    //          abandoned once its upper bound falls below the k-th best
+    //          score found so far, since it can no longer reach the top k.
+    //          The bound adds to the label's partial score the sum of the
+    //          row maxima of the words still to add, found once per post
+    //          as suffix sums. Adds the work done to stats.
+    std::vector<Prediction> predict_top_k(const std::vector<int> &words, 
+                                          int k, Pruning_stats &stats) const
+    {
+        size_t top = std::min(k, label_count);
+        // the best labels so far, as a heap with the lowest ranked in front
+        std::vector<Prediction> best;
+        size_t word_count = words.size();
+        stats.labels += label_count;
+        stats.full_additions += uint64_t(label_count) * word_count;
+        // the most that words[i] .. words[word_count - 1] can add to any
+        // label's score
+        std::vector<double> remaining_max(word_count + 1, 0);
+        for (size_t i = word_count; i > 0; --i) {
+            remaining_max[i - 1] = 
+                remaining_max[i] + max_log_likelihood[words[i - 1]];
+        }
+
+        for (int label : labels_by_prior) {
+            double score = label_log_prior[label];
+            size_t added = 0;
+            bool pruned = false;
+            while (true) {
+                if (best.size() == top 
+                    && upper_bound(score, remaining_max[added]) 
+                       < best.front().log_probability) {
+                    pruned = true;
+                    break;
+                }
+                if (added == word_count) {
+                    break;
+                }
+                size_t end = std::min(word_count, added + pruning_interval);
+                for (; added < end; ++added) {
+                    score += log_likelihood[words[added] * label_stride + label];
+                }
+            }
+            stats.additions += added;
+            if (pruned) {
+                ++stats.pruned_labels;
+                continue;
+            }
+
+            Prediction prediction = { label, score };
+            if (best.size() < top) {
+                best.push_back(prediction);
+                std::push_heap(best.begin(), best.end(), ranks_ahead);
+            }
+            else if (ranks_ahead(prediction, best.front())) {
+                std::pop_heap(best.begin(), best.end(), ranks_ahead);
+                best.back() = prediction;
+                std::push_heap(best.begin(), best.end(), ranks_ahead);
+            }
+        }
+        std::sort(best.begin(), best.end(), ranks_ahead);
+        return best;
+    }
+
+    // EFFECTS: Returns whether predict uses the AVX2 kernel on this CPU.
+    static bool has_avx2()
+    {
+#ifdef MODEL_HAS_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+private:
+    // MODIFIES: this
+    // EFFECTS: Sizes the tables for data and computes their entries. Rows
+    //          from first_new_word on are computed from scratch. In earlier
+    //          rows, an entry for a word seen with a label depends only on
+    //          the counts of that label, so it is kept unless data has
+    //          changes for the label. The other entries, and the
+    //          priors, depend on the post count and are always recomputed.
+    void compute_tables(const Data *data, int first_new_word)
+    {
+        prior_storage.assign(label_stride, std::log(0));
+        for (int label = 0; label < label_count; ++label) {
+            prior_storage[label] = 
+                std::log(data->get_label_frequency(label)/data->get_post_count());
+        }
+
+        int word_count = words.size();
+        if (first_new_word == 0) {
+            log_likelihood_storage.assign((word_count + 1) * label_stride, 0);
+        }
+        else {
+            log_likelihood_storage.resize((word_count + 1) * label_stride, 0);
+        }
+        for (int word = 0; word < word_count; ++word) {
+            for (int label = 0; label < label_count; ++label) {
+                double count = data->get_label_word_frequency(label, word);
+                if (count == 0 || word >= first_new_word 
+                    || data->has_changes(label)) {
+                    log_likelihood_storage[word * label_stride + label] = 
+                        get_smoothed_log_likelihood(*data, label, word, alpha);
+                }
+            }
+        }
+        for (int label = 0; label < label_count; ++label) {
+            log_likelihood_storage[word_count * label_stride + label] = 
+                get_smoothed_log_likelihood(*data, label, word_count, alpha);
+        }
+
+        max_log_likelihood_storage.assign(word_count + 1, std::log(0));
+        for (int word = 0; word <= word_count; ++word) {
+            for (int label = 0; label < label_count; ++label) {
+                max_log_likelihood_storage[word] = std::max(
+                    max_log_likelihood_storage[word], 
+                    log_likelihood_storage[word * label_stride + label]);
+            }
+        }
+
+        label_log_prior = prior_storage.data();
+        log_likelihood = log_likelihood_storage.data();
+        max_log_likelihood = max_log_likelihood_storage.data();
+        order_labels();
+    }
+
+    // MODIFIES: this
+    // EFFECTS: Sorts labels_by_prior from the highest log-prior down, so
+    //          predict_top_k finds likely winners, and a high threshold,
+    //          early.
+    void order_labels()
+    {
+        labels_by_prior.resize(label_count);
+        for (int label = 0; label < label_count; ++label) {
+            labels_by_prior[label] = label;
+        }
+        std::stable_sort(labels_by_prior.begin(), labels_by_prior.end(), 
+            [this](int lhs, int rhs) {
+                return label_log_prior[lhs] > label_log_prior[rhs];
+            });
+    }
+
+    // EFFECTS: Returns an upper bound on the final score of a label whose
+    //          score so far is partial, with words still to add that add at
+    //          most remaining_max. Every log-likelihood is at most 0, so
+    //          the bound only falls as words are added. It is loosened
+    //          slightly so that rounding in the additions still being made,
+    //          and in the sum remaining_max, cannot exceed it.
+    static double upper_bound(double partial, double remaining_max)
+    {
+        double bound = partial + remaining_max;
+        return bound + 1e-9 * (std::fabs(partial) + std::fabs(remaining_max));
+    }
+
+    // MODIFIES: sorted
+    // EFFECTS: Returns the value that occurs most often among the first
+    //          label_count entries of row, the lowest of those tied.
+    //          sorted is scratch space.
+    double most_common(const double *row, std::vector<double> &sorted) const
+    {
+        sorted.assign(row, row + label_count);
+        std::sort(sorted.begin(), sorted.end());
+        double value = 0;
+        size_t best_run = 0;
+        for (size_t i = 0; i < sorted.size(); ) {
+            size_t run = 1;
+            while (i + run < sorted.size() && sorted[i + run] == sorted[i]) {
+                ++run;
+            }
+            if (run > best_run) {
+                value = sorted[i];
+                best_run = run;
+            }
+            i += run;
+        }
+        return value;
+    }
+
+    // REQUIRES: scores holds at least label_count scores
+    // EFFECTS: Returns the first label with the highest of the scores, or
+    //          the unknown label ID with a score of -inf if there are no
+    //          labels.
+    Prediction first_best(const std::vector<double> &scores) const
+    {
+        Prediction best = { labels.get_unknown_id(), std::log(0) };
+        for (int label = 0; label < label_count; ++label) {
+            if (scores[label] > best.log_probability) {
+                best.label = label;
+                best.log_probability = scores[label];
+            }
+        }
+        return best;
+    }
+
+    // EFFECTS: Returns whether a is ranked ahead of b: a higher score, or
+    //          an equal score and a lower label ID.
+    static bool ranks_ahead(const Prediction &a, const Prediction &b)
+    {
+        return a.log_probability > b.log_probability 
+            || (a.log_probability == b.log_probability && a.label < b.label);
+    }
+
+#ifdef MODEL_HAS_AVX2
+    // REQUIRES: label_count > 0, and scores has room for label_stride
+    //           doubles
+    // MODIFIES: scores
+    // EFFECTS: Scores every label, one vector of labels at a time, and
+    //          returns the first label with the highest score. Each lane
+    //          adds the rows in the same order as get_log_probability, so
+    //          the scores are exactly the scalar ones.
+    __attribute__((target("avx2")))
+    int predict_avx2(const std::vector<int> &words, double *scores) const
+    {
+        for (int label = 0; label < label_stride; label += lanes) {
+            _mm256_storeu_pd(scores + label, 
+                             _mm256_loadu_pd(label_log_prior + label));
+        }
+        for (int word : words) {
+            const double *row = &log_likelihood[word * label_stride];
+            for (int label = 0; label < label_stride; label += lanes) {
+                _mm256_storeu_pd(scores + label, 
+                    _mm256_add_pd(_mm256_loadu_pd(scores + label), 
+                                  _mm256_loadu_pd(row + label)));
+            }
+        }
+        return first_best_avx2(scores);
+    }
+
+    // REQUIRES: label_count > 0, and scores has room for label_stride
+    //           doubles
+    // MODIFIES: scores
+    // EFFECTS: Same as above, adding each row times the count of its word.
+    //          The product is rounded before the sum, as in the scalar
+    //          kernel, rather than fused with it.
+    __attribute__((target("avx2")))
+    int predict_avx2(const std::vector<int> &words, 
+                     const std::vector<int> &counts, double *scores) const
+    {
+        for (int label = 0; label < label_stride; label += lanes) {
+            _mm256_storeu_pd(scores + label, 
+                             _mm256_loadu_pd(label_log_prior + label));
+        }
+        for (size_t i = 0; i < words.size(); ++i) {
+            const double *row = &log_likelihood[words[i] * label_stride];
+            __m256d count = _mm256_set1_pd(counts[i]);
+            for (int label = 0; label < label_stride; label += lanes) {
+                _mm256_storeu_pd(scores + label, 
+                    _mm256_add_pd(_mm256_loadu_pd(scores + label), 
+                                  _mm256_mul_pd(count, 
+                                                _mm256_loadu_pd(row + label))));
+            }
+        }
+        return first_best_avx2(scores);
+    }
+
+    // REQUIRES: label_count > 0, and scores holds label_stride scores
+    // EFFECTS: Returns the first label with the highest score.
+    __attribute__((target("avx2")))
+    int first_best_avx2(const double *scores) const
+    {
+        // the highest score, reduced across all lanes
+        __m256d best = _mm256_loadu_pd(scores);
+        for (int label = lanes; label < label_stride; label += lanes) {
+            best = _mm256_max_pd(best, _mm256_loadu_pd(scores + label));
+        }
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(best), 
+                                  _mm256_extractf128_pd(best, 1));
+        half = _mm_max_sd(half, _mm_unpackhi_pd(half, half));
+        __m256d target = _mm256_set1_pd(_mm_cvtsd_f64(half));
+
+        // the first lane holding it
+        for (int label = 0; label < label_stride; label += lanes) {
+            int mask = _mm256_movemask_pd(
+                _mm256_cmp_pd(_mm256_loadu_pd(scores + label), target, _CMP_EQ_OQ));
+            if (mask) {
+                return label + __builtin_ctz(mask);
+            }
+        }
+        return 0;
+    }
+#endif
+};
+
+// Splits posts into their unique words, as views of the post itself,
+// and optionally their n-grams, or into every occurrence of them for term
+// counts. The buffers are kept from one post to the
+// next, so tokenizing a stream of posts allocates only when a post has
+// more words than any before it. Words are delimited by the characters
+// isspace accepts in the "C" locale, as when reading words with >> from
+// an istream.
+//
+// An n-gram of n > 1 consecutive words is represented by a key string:
+// a space, which no word contains, the digit n, and the 8 bytes of a
+// polynomial hash of the FNV-1a hashes of its words. The hashes of the
+// n-grams of each length are rolled along the post in one pass, so no
+// word strings are joined. Keys are interned or hashed like any word.
+class Tokenizer
+{
+private:
+    std::vector<std::string_view> words;
+    std::vector<int> ids;
+    std::vector<int> counts;
+    // the hash of every word of a post, in order
+    std::vector<uint64_t> word_hashes;
+    std::string keys;
+
+    // the multiplier of the n-gram hash
+    static constexpr uint64_t ngram_base = 1099511628211ull;
+
+public:
+    static constexpr size_t ngram_key_size = 2 + sizeof(uint64_t);
+
+    // REQUIRES: ngram_order > 0
+    // MODIFIES: keys
+    // EFFECTS: Returns the unique whitespace delimited words of str, and
+    //          the keys of its unique n-grams of 2 .. ngram_order words, in
+    //          sorted order. The keys are written to keys. The result is
+    //          overwritten by the next call and refers to the characters of
+    //          str and keys, which must not change while it is used.
+    const std::vector<std::string_view> & get_unique_words(
+        std::string_view str, int ngram_order, std::string &keys)
+    {
+        return get_features(str, ngram_order, false, keys);
+    }
+
+    // EFFECTS: Same as above, writing the keys to a buffer of this
+    //          Tokenizer.
+    const std::vector<std::string_view> & get_unique_words(
+        std::string_view str, int ngram_order = 1)
+    {
+        return get_features(str, ngram_order, false, keys);
+    }
+
+    // REQUIRES: ngram_order > 0
+    // MODIFIES: keys
+    // EFFECTS: Same as get_unique_words, but if term_counts is true a word
+    //          or n-gram is in the result as often as it occurs in str.
+    const std::vector<std::string_view> & get_features(
+        std::string_view str, int ngram_order, bool term_counts, 
+        std::string &keys)
+    {
+        words.clear();
+        word_hashes.clear();
+        const char *end = str.data() + str.size();
+        const char *start = skip(str.data(), end, true);
+        while (start != end) {
+            const char *stop = skip(start, end, false);
+            words.emplace_back(start, stop - start);
+            if (ngram_order > 1) {
+                word_hashes.push_back(Vocabulary::hash(words.back()));
+            }
+            start = skip(stop, end, true);
+        }
+        add_ngram_keys(ngram_order, keys);
+        std::sort(words.begin(), words.end());
+        if (!term_counts) {
+            words.erase(std::unique(words.begin(), words.end()), words.end());
+        }
+        return words;
+    }
+
+    // EFFECTS: Same as above, writing the keys to a buffer of this
+    //          Tokenizer.
+    const std::vector<std::string_view> & get_features(
+        std::string_view str, int ngram_order, bool term_counts)
+    {
+        return get_features(str, ngram_order, term_counts, keys);
+    }
+
+    // EFFECTS: Returns the IDs of the unique whitespace delimited words of
+    //          str, and of its n-grams up to the ngram order of the
+    //          vocabulary, in sorted word order. Words outside the
+    //          vocabulary get the unknown word ID. For a hashed vocabulary,
+    //          or one with term counts, returns the unique IDs in
+    //          increasing order instead. The result is overwritten by the
+    //          next call.
+    const std::vector<int> & get_word_ids(const Vocabulary &vocabulary, 
+                                          std::string_view str)
+    {
+        ids.clear();
+        for (std::string_view word : 
+             get_features(str, vocabulary.get_ngram_order(), 
+                          vocabulary.has_term_counts())) {
+            ids.push_back(vocabulary.get_id(word));
+        }
+        if (vocabulary.has_term_counts()) {
+            count_runs(ids, counts);
+        }
+        else {
+            vocabulary.remove_collisions(ids);
+            counts.assign(ids.size(), 1);
+        }
+        return ids;
+    }
+
+    // EFFECTS: Returns how often each ID returned by the last call to
+    //          get_word_ids occurs in its post if the vocabulary has term
+    //          counts, and otherwise 1 for each.
+    const std::vector<int> & get_counts() const
+    {
+        return counts;
+    }
+
+    // EFFECTS: Returns whether word is the key of an n-gram.
+    static bool is_ngram_key(std::string_view word)
+    {
+        return !word.empty() && word[0] == ' ';
+    }
+
+private:
+    // REQUIRES: word_hashes holds the hashes of the words of a post
+    // MODIFIES: words, keys
+    // EFFECTS: Adds the key of every n-gram of 2 .. ngram_order words of
+    //          the post to words, writing the keys to keys. Each n-gram
+    //          hash is the sum of its word hashes times powers of
+    //          ngram_base, the first word's the highest, so the next one is
+    //          found from it by removing the first word and adding a word.
+    void add_ngram_keys(int ngram_order, std::string &keys)
+    {
+        size_t word_count = word_hashes.size();
+        size_t key_count = 0;
+        for (int n = 2; n <= ngram_order && size_t(n) <= word_count; ++n) {
+            key_count += word_count - n + 1;
+        }
+        // sized up front, so the views taken below stay valid
+        keys.resize(key_count * ngram_key_size);
+        char *key = &keys[0];
+        for (int n = 2; n <= ngram_order && size_t(n) <= word_count; ++n) {
+            // ngram_base^(n - 1), the power of the first word of an n-gram
+            uint64_t first_power = 1;
+            uint64_t ngram_hash = 0;
+            for (int i = 0; i < n; ++i) {
+                ngram_hash = ngram_hash * ngram_base + word_hashes[i];
+                if (i > 0) {
+                    first_power *= ngram_base;
+                }
+            }
+            for (size_t i = n; ; ++i) {
+                key[0] = ' ';
+                key[1] = char('0' + n);
+                std::memcpy(key + 2, &ngram_hash, sizeof(ngram_hash));
+                words.emplace_back(key, ngram_key_size);
+                key += ngram_key_size;
+                if (i == word_count) {
+                    break;
+                }
+                ngram_hash = (ngram_hash - word_hashes[i - n] * first_power) 
+                             * ngram_base + word_hashes[i];
+            }
+        }
+    }
+
+    static bool is_space(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+    // EFFECTS: Returns the first character from begin on that is
+    //          whitespace, if space is false, or that is not, if space is
+    //          true; end if there is none.
+    static const char * skip(const char *begin, const char *end, bool space)
+    {
+#ifdef MODEL_HAS_SSE2
+        // bit i of the mask is set if begin[i] is whitespace: a space, or
+        // '\t' .. '\r', which are 0 .. 4 after subtracting '\t'
+        const __m128i blank = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i range = _mm_set1_epi8('\r' - '\t');
+        for (; end - begin >= 16; begin += 16) {
+            __m128i chunk = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(begin));
+            __m128i offset = _mm_sub_epi8(chunk, tab);
+            __m128i spaces = _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, blank), 
+                _mm_cmpeq_epi8(_mm_min_epu8(offset, range), offset));
+            int mask = _mm_movemask_epi8(spaces);
+            if (space) {
+                mask = ~mask & 0xFFFF;
+            }
+            if (mask) {
+                return begin + __builtin_ctz(mask);
+            }
+        }
+#endif
+        while (begin != end && is_space(*begin) == space) {
+            ++begin;
+        }
+        return begin;
+    }
+};
+
+inline Prediction Model::predict_post(Tokenizer &tokenizer, 
+                                      std::string_view content, 
+                                      std::vector<double> &scores) const
+{
+    const std::vector<int> &ids = tokenizer.get_word_ids(words, content);
+    if (words.has_term_counts()) {
+        return predict(ids, tokenizer.get_counts(), scores);
+    }
+    return predict(ids, scores);
+}
+
+#endif // MODEL_HPP
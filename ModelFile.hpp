@@ -0,0 +1,398 @@
+#ifndef MODEL_FILE_HPP
+#define MODEL_FILE_HPP
+/* ModelFile.hpp
+ *
+ * Saving a trained Model to a binary file, and loading it back by mapping
+ * the file into memory. A loaded Model reads its vocabularies and tables
+ * straight from the mapping, so loading takes the same time for any size
+ * of training corpus; pages are read from disk as scoring touches them.
+ *
+ * A model file is a Model_file_header followed by these sections, each
+ * starting on an 8-byte boundary:
+ *
+ *   label offsets         uint64_t[label_count + 1]
+ *   label hash slots      uint32_t[label_slot_count]
+ *   word offsets          uint64_t[word_count + 1], or none if hashed
+ *   word hash slots       uint32_t[word_slot_count]
+ *   log-priors            double[label_stride]
+ *   log-likelihoods       double[(word_count + 1) * label_stride]
+ *   max log-likelihoods   double[word_count + 1]
+ *   label counts          double[label_count]
+ *   word counts           double[word_count]
+ *   label-word counts     double[word_count * label_count]
+ *   label characters      char[label_char_count]
+ *   word characters       char[word_char_count]
+ *
+ * These are the arrays of Vocabulary, Model and Data as they are in
+ * memory. A hashed word Vocabulary has no arrays; the header records its
+ * hash bits, and its word count is the number of buckets. The header also
+ * records the ngram order of the word Vocabulary and whether it has term
+ * counts. Integers and doubles are stored in the byte order of the
+ * machine that saved the file; loading a file from a machine with the
+ * other byte order fails rather than misreading it.
+ *
+ * A model is saved to a temporary file next to the target, which is then
+ * renamed over it, so a failed save leaves any earlier file in place. A
+ * loaded file is checked before it is used: besides its header, the
+ * offsets and hash slots of its vocabularies, since a lookup follows them
+ * without bounds checks. Checking them reads those arrays once; the
+ * tables are still only read as scoring touches them.
+ */
+
+#include "Model.hpp"
+#include <cstdint>  //uint32_t, uint64_t
+#include <cstdio>   //rename, remove
+#include <cstring>  //memcmp, memcpy
+#include <exception>
+#include <fstream>  //ofstream
+#include <memory>   //shared_ptr
+#include <string>   //string
+#include <vector>   //vector
+#include <fcntl.h>    //open
+#include <sys/mman.h> //mmap, munmap
+#include <sys/stat.h> //fstat
+#include <unistd.h>   //close
+
+// A custom exception type
+class model_file_exception : public std::exception {
+public:
+  const char * what () const noexcept override {
+    return msg.c_str();
+  }
+  const std::string msg;
+  model_file_exception(const std::string &msg) : msg(msg) {};
+};
+
+struct Model_file_header {
+  // Change version whenever the layout changes.
+  static constexpr char magic_value[8] = "NBMODEL";
+  static const uint32_t current_version = 6;
+  static const uint32_t byte_order_value = 0x01020304;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t post_count;
+  uint64_t label_count;
+  uint64_t label_stride;
+  uint64_t word_count;
+  // see Vocabulary::get_hash_bits, get_ngram_order and has_term_counts
+  uint64_t word_hash_bits;
+  uint64_t word_ngram_order;
+  uint64_t word_term_counts;
+  uint64_t label_slot_count;
+  uint64_t word_slot_count;
+  uint64_t label_char_count;
+  uint64_t word_char_count;
+  uint64_t file_size;
+};
+
+// The byte offset of every section of a model file
+struct Model_file_layout {
+  uint64_t label_offsets;
+  uint64_t label_slots;
+  uint64_t word_offsets;
+  uint64_t word_slots;
+  uint64_t log_prior;
+  uint64_t log_likelihood;
+  uint64_t max_log_likelihood;
+  uint64_t label_frequency;
+  uint64_t word_frequency;
+  uint64_t label_word_frequency;
+  uint64_t label_chars;
+  uint64_t word_chars;
+  uint64_t file_size;
+
+  explicit Model_file_layout(const Model_file_header &header) {
+    uint64_t end = sizeof(Model_file_header);
+    label_offsets = section(end, (header.label_count + 1) * sizeof(uint64_t));
+    label_slots = section(end, header.label_slot_count * sizeof(uint32_t));
+    word_offsets = section(end, header.word_hash_bits > 0 ? 0
+                                : (header.word_count + 1) * sizeof(uint64_t));
+    word_slots = section(end, header.word_slot_count * sizeof(uint32_t));
+    log_prior = section(end, header.label_stride * sizeof(double));
+    log_likelihood = section(end, (header.word_count + 1)
+                                  * header.label_stride * sizeof(double));
+    max_log_likelihood = section(end, (header.word_count + 1)
+                                      * sizeof(double));
+    label_frequency = section(end, header.label_count * sizeof(double));
+    word_frequency = section(end, header.word_count * sizeof(double));
+    label_word_frequency = section(end, header.word_count * header.label_count
+                                        * sizeof(double));
+    label_chars = section(end, header.label_char_count);
+    word_chars = section(end, header.word_char_count);
+    file_size = end;
+  }
+
+  // MODIFIES: end
+  // EFFECTS : Returns the offset of a section of the given size that
+  //           starts at end, rounded up to 8 bytes, and moves end past it.
+  static uint64_t section(uint64_t &end, uint64_t size) {
+    uint64_t start = (end + 7) / 8 * 8;
+    end = start + size;
+    return start;
+  }
+};
+
+// Writes the sections of a model file in order, padding between them.
+class Model_file_writer {
+public:
+  explicit Model_file_writer(const std::string &file_name)
+    : out(file_name, std::ios::binary), position(0) {
+    if (!out) {
+      throw model_file_exception("Error opening model file: " + file_name);
+    }
+  }
+
+  // REQUIRES: offset is not before the end of what was written so far
+  // EFFECTS : Writes count values starting at the given offset.
+  template <typename T>
+  void write(uint64_t offset, const T *values, uint64_t count) {
+    static const char zeros[8] = { 0 };
+    out.write(zeros, offset - position);
+    out.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+    position = offset + count * sizeof(T);
+  }
+
+  bool good() const {
+    return bool(out);
+  }
+
+  // EFFECTS : Flushes and closes the file, and returns whether everything
+  //           was written.
+  bool close() {
+    out.close();
+    return bool(out);
+  }
+
+private:
+  std::ofstream out;
+  uint64_t position;
+};
+
+// REQUIRES: model was built from data
+// EFFECTS : Writes data and model to the named file, replacing it. They
+//           are written to file_name + ".tmp", which is renamed to
+//           file_name once complete. Throws model_file_exception if the
+//           file cannot be written, leaving any earlier file in place.
+inline void save_model(const std::string &file_name, const Data &data,
+                       const Model &model) {
+  const Vocabulary &labels = model.get_labels();
+  const Vocabulary &words = model.get_words();
+
+  Model_file_header header;
+  std::memcpy(header.magic, Model_file_header::magic_value,
+              sizeof(header.magic));
+  header.version = Model_file_header::current_version;
+  header.byte_order = Model_file_header::byte_order_value;
+  header.post_count = model.get_post_count();
+  header.label_count = labels.size();
+  header.label_stride = Model::get_label_stride(labels.size());
+  header.word_count = words.size();
+  header.word_hash_bits = words.get_hash_bits();
+  header.word_ngram_order = words.get_ngram_order();
+  header.word_term_counts = words.has_term_counts();
+  header.label_slot_count = labels.get_slot_count();
+  header.word_slot_count = words.get_slot_count();
+  header.label_char_count = labels.get_offsets()[labels.size()];
+  header.word_char_count = header.word_hash_bits > 0 ? 0
+                           : words.get_offsets()[words.size()];
+  Model_file_layout layout(header);
+  header.file_size = layout.file_size;
+
+  std::vector<double> label_frequency;
+  for (int label = 0; label < labels.size(); ++label) {
+    label_frequency.push_back(data.get_label_frequency(label));
+  }
+  std::vector<double> word_frequency;
+  std::vector<double> label_word_frequency;
+  for (int word = 0; word < words.size(); ++word) {
+    word_frequency.push_back(data.get_word_frequency(word));
+    for (int label = 0; label < labels.size(); ++label) {
+      label_word_frequency.push_back(
+        data.get_label_word_frequency(label, word));
+    }
+  }
+
+  std::string temp_name = file_name + ".tmp";
+  Model_file_writer out(temp_name);
+  out.write(0, &header, 1);
+  out.write(layout.label_offsets, labels.get_offsets(),
+            header.label_count + 1);
+  out.write(layout.label_slots, labels.get_slots(), header.label_slot_count);
+  if (header.word_hash_bits == 0) {
+    out.write(layout.word_offsets, words.get_offsets(), header.word_count + 1);
+  }
+  out.write(layout.word_slots, words.get_slots(), header.word_slot_count);
+  out.write(layout.log_prior, model.get_log_prior_table(),
+            header.label_stride);
+  out.write(layout.log_likelihood, model.get_log_likelihood_table(),
+            (header.word_count + 1) * header.label_stride);
+  out.write(layout.max_log_likelihood, model.get_max_log_likelihood_table(),
+            header.word_count + 1);
+  out.write(layout.label_frequency, label_frequency.data(),
+            label_frequency.size());
+  out.write(layout.word_frequency, word_frequency.data(),
+            word_frequency.size());
+  out.write(layout.label_word_frequency, label_word_frequency.data(),
+            label_word_frequency.size());
+  out.write(layout.label_chars, labels.get_chars(), header.label_char_count);
+  out.write(layout.word_chars, words.get_chars(), header.word_char_count);
+  if (!out.close()
+      || std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+    std::remove(temp_name.c_str());
+    throw model_file_exception("Error writing model file: " + file_name);
+  }
+}
+
+// EFFECTS : Returns whether the counts in header are small enough for
+//           their sections to fit in a file of the given size, so that
+//           computing the layout of a corrupted header cannot overflow.
+inline bool model_file_counts_fit(const Model_file_header &header,
+                                  uint64_t size) {
+  // every label and word has a frequency, a double, in the file
+  uint64_t doubles = size / sizeof(double);
+  uint64_t slots = size / sizeof(uint32_t);
+  return header.label_count <= doubles && header.word_count <= doubles
+         && header.label_count < INT32_MAX && header.word_count < INT32_MAX
+         && header.label_stride <= doubles
+         && (header.label_stride == 0
+             || header.word_count + 1 <= doubles / header.label_stride)
+         && (header.label_count == 0
+             || header.word_count <= doubles / header.label_count)
+         && header.label_slot_count <= slots
+         && header.word_slot_count <= slots
+         && header.label_char_count <= size
+         && header.word_char_count <= size;
+}
+
+// EFFECTS : Returns whether the arrays of a Vocabulary of count strings
+//           are consistent: offsets start at 0, never decrease and end at
+//           char_count, and slot_count is a power of two at least twice
+//           count, with every ID in exactly one slot and every other slot
+//           empty. Lookups then stay within the arrays and always reach an
+//           empty slot.
+inline bool is_valid_vocabulary(uint64_t count, const uint64_t *offsets,
+                                uint64_t char_count, const uint32_t *slots,
+                                uint64_t slot_count) {
+  if (offsets[0] != 0 || offsets[count] != char_count) {
+    return false;
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    if (offsets[i] > offsets[i + 1]) {
+      return false;
+    }
+  }
+  if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0
+      || slot_count < 2 * count) {
+    return false;
+  }
+  std::vector<bool> seen(count, false);
+  uint64_t filled = 0;
+  for (uint64_t slot = 0; slot < slot_count; ++slot) {
+    if (slots[slot] != UINT32_MAX) {
+      if (slots[slot] >= count || seen[slots[slot]]) {
+        return false;
+      }
+      seen[slots[slot]] = true;
+      ++filled;
+    }
+  }
+  return filled == count;
+}
+
+// EFFECTS : Maps the named model file into memory and returns a Model
+//           that reads from it. Throws model_file_exception if the file
+//           cannot be read or is not a valid model file of this version.
+inline Model load_model(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat status;
+  if (fd < 0 || fstat(fd, &status) != 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    throw model_file_exception("Error opening model file: " + file_name);
+  }
+  uint64_t size = status.st_size;
+  void *address = size < sizeof(Model_file_header) ? MAP_FAILED
+    : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw model_file_exception("Error reading model file: " + file_name);
+  }
+  // unmapped when the last Model using it is destroyed
+  std::shared_ptr<const void> mapping(address, [size](const void *p) {
+    munmap(const_cast<void *>(p), size);
+  });
+
+  const char *base = static_cast<const char *>(address);
+  const Model_file_header &header =
+    *reinterpret_cast<const Model_file_header *>(base);
+  if (std::memcmp(header.magic, Model_file_header::magic_value,
+                  sizeof(header.magic)) != 0
+      || header.version != Model_file_header::current_version
+      || header.byte_order != Model_file_header::byte_order_value
+      || header.file_size != size
+      || !model_file_counts_fit(header, size)
+      || Model_file_layout(header).file_size != size
+      || header.label_stride
+         != uint64_t(Model::get_label_stride(header.label_count))
+      || header.word_ngram_order < 1 || header.word_ngram_order > 9
+      || header.word_term_counts > 1
+      || (header.word_hash_bits > 0
+          && (header.word_hash_bits >= 31
+              || header.word_count != uint64_t(1) << header.word_hash_bits
+              || header.word_slot_count != 0
+              || header.word_char_count != 0))) {
+    throw model_file_exception("Error reading model file: " + file_name
+                               + " is not a model file of version "
+                               + std::to_string(
+                                   Model_file_header::current_version));
+  }
+
+  Model_file_layout layout(header);
+  auto section = [base](uint64_t offset) { return base + offset; };
+  if (!is_valid_vocabulary(
+        header.label_count,
+        reinterpret_cast<const uint64_t *>(section(layout.label_offsets)),
+        header.label_char_count,
+        reinterpret_cast<const uint32_t *>(section(layout.label_slots)),
+        header.label_slot_count)
+      || (header.word_hash_bits == 0
+          && !is_valid_vocabulary(
+                header.word_count,
+                reinterpret_cast<const uint64_t *>(
+                  section(layout.word_offsets)),
+                header.word_char_count,
+                reinterpret_cast<const uint32_t *>(
+                  section(layout.word_slots)),
+                header.word_slot_count))) {
+    throw model_file_exception("Error reading model file: " + file_name
+                               + " has corrupted vocabularies");
+  }
+  Vocabulary labels(
+    header.label_count,
+    reinterpret_cast<const uint64_t *>(section(layout.label_offsets)),
+    section(layout.label_chars),
+    reinterpret_cast<const uint32_t *>(section(layout.label_slots)),
+    header.label_slot_count);
+  Vocabulary words = header.word_hash_bits > 0
+    ? Vocabulary::hashed(header.word_hash_bits)
+    : Vocabulary(
+        header.word_count,
+        reinterpret_cast<const uint64_t *>(section(layout.word_offsets)),
+        section(layout.word_chars),
+        reinterpret_cast<const uint32_t *>(section(layout.word_slots)),
+        header.word_slot_count);
+  words.set_ngram_order(header.word_ngram_order);
+  words.set_term_counts(header.word_term_counts);
+  return Model(header.post_count, std::move(words), std::move(labels),
+               reinterpret_cast<const double *>(section(layout.log_prior)),
+               reinterpret_cast<const double *>(
+                 section(layout.log_likelihood)),
+               reinterpret_cast<const double *>(
+                 section(layout.max_log_likelihood)),
+               std::move(mapping));
+}
+
+#endif // MODEL_FILE_HPP
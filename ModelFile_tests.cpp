@@ -0,0 +1,180 @@
+#include "ModelFile.hpp"
+#include "unit_test_framework.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A few training posts, as the label and unique words of each.
+static Posts make_posts() {
+    return Posts({
+        { "euchre", { "bob", "dealer", "trump" } },
+        { "euchre", { "bob", "segfault", "trump" } },
+        { "calculator", { "countif", "stack", "segfault" } },
+        { "calculator", { "countif", "function", "stack" } },
+        { "recursion", { "base", "case", "stack" } },
+    });
+}
+
+static std::string read_file(const std::string &file_name) {
+    std::ifstream in(file_name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string &file_name,
+                       const std::string &bytes) {
+    std::ofstream out(file_name, std::ios::binary);
+    out.write(bytes.data(), bytes.size());
+}
+
+static bool load_fails(const std::string &file_name) {
+    try {
+        load_model(file_name);
+    }
+    catch (const model_file_exception &) {
+        return true;
+    }
+    return false;
+}
+
+// Saves a model of make_posts, and returns the bytes of the file.
+static std::string save_posts(const std::string &file_name) {
+    Data data(make_posts());
+    Model model(&data);
+    save_model(file_name, data, model);
+    return read_file(file_name);
+}
+
+template <typename T>
+static T * at(std::string &bytes, uint64_t offset) {
+    return reinterpret_cast<T *>(&bytes[offset]);
+}
+
+TEST(test_round_trip) {
+    const std::string file_name = "ModelFile_tests_round_trip.model";
+    Data data(make_posts());
+    Model model(&data);
+    save_model(file_name, data, model);
+    Model loaded = load_model(file_name);
+
+    ASSERT_EQUAL(loaded.get_post_count(), model.get_post_count());
+    ASSERT_EQUAL(loaded.get_label_count(), model.get_label_count());
+    ASSERT_EQUAL(loaded.get_words().size(), model.get_words().size());
+    for (int word = 0; word <= model.get_words().size(); ++word) {
+        for (int label = 0; label < model.get_label_count(); ++label) {
+            ASSERT_EQUAL(loaded.get_log_likelihood(label, word),
+                         model.get_log_likelihood(label, word));
+        }
+    }
+    std::vector<int> words = { loaded.get_words().get_id("stack"),
+                               loaded.get_words().get_id("segfault") };
+    Prediction prediction = loaded.predict(words);
+    ASSERT_EQUAL(loaded.get_labels().get_string(prediction.label),
+                 "calculator");
+    ASSERT_FALSE(std::ifstream(file_name + ".tmp").is_open());
+    std::remove(file_name.c_str());
+}
+
+TEST(test_failed_save_keeps_old_file) {
+    const std::string file_name = "ModelFile_tests_failed_save.model";
+    std::string before = save_posts(file_name);
+    // the temporary file cannot be created where a directory is
+    ASSERT_EQUAL(mkdir((file_name + ".tmp").c_str(), 0700), 0);
+
+    Data data(Posts({ { "other", { "word" } } }));
+    Model model(&data);
+    bool caught = false;
+    try {
+        save_model(file_name, data, model);
+    }
+    catch (const model_file_exception &) {
+        caught = true;
+    }
+    rmdir((file_name + ".tmp").c_str());
+    ASSERT_TRUE(caught);
+    ASSERT_EQUAL(read_file(file_name), before);
+    std::remove(file_name.c_str());
+}
+
+TEST(test_truncated_file) {
+    const std::string file_name = "ModelFile_tests_truncated.model";
+    std::string bytes = save_posts(file_name);
+    for (size_t size : { size_t(0), size_t(4), sizeof(Model_file_header),
+                         bytes.size() / 2, bytes.size() - 1 }) {
+        write_file(file_name, bytes.substr(0, size));
+        ASSERT_TRUE(load_fails(file_name));
+    }
+    std::remove(file_name.c_str());
+}
+
+TEST(test_corrupted_header) {
+    const std::string file_name = "ModelFile_tests_header.model";
+    std::string bytes = save_posts(file_name);
+
+    std::string corrupted = bytes;
+    at<Model_file_header>(corrupted, 0)->word_count = uint64_t(1) << 62;
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+
+    corrupted = bytes;
+    at<Model_file_header>(corrupted, 0)->version += 1;
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+    std::remove(file_name.c_str());
+}
+
+TEST(test_corrupted_offsets) {
+    const std::string file_name = "ModelFile_tests_offsets.model";
+    std::string bytes = save_posts(file_name);
+    Model_file_layout layout(*at<Model_file_header>(bytes, 0));
+
+    // past the end of the characters
+    std::string corrupted = bytes;
+    at<uint64_t>(corrupted, layout.word_offsets)[1] = 1000;
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+
+    // decreasing
+    corrupted = bytes;
+    uint64_t *offsets = at<uint64_t>(corrupted, layout.label_offsets);
+    offsets[1] = offsets[2] + 1;
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+    std::remove(file_name.c_str());
+}
+
+TEST(test_corrupted_slots) {
+    const std::string file_name = "ModelFile_tests_slots.model";
+    std::string bytes = save_posts(file_name);
+    const Model_file_header &header = *at<Model_file_header>(bytes, 0);
+    Model_file_layout layout(header);
+
+    // an ID past the last word
+    std::string corrupted = bytes;
+    uint32_t *slots = at<uint32_t>(corrupted, layout.word_slots);
+    for (uint64_t slot = 0; slot < header.word_slot_count; ++slot) {
+        if (slots[slot] != UINT32_MAX) {
+            slots[slot] = header.word_count;
+            break;
+        }
+    }
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+
+    // every slot full, so a lookup of an unknown word would never end
+    corrupted = bytes;
+    slots = at<uint32_t>(corrupted, layout.label_slots);
+    for (uint64_t slot = 0; slot < header.label_slot_count; ++slot) {
+        slots[slot] = 0;
+    }
+    write_file(file_name, corrupted);
+    ASSERT_TRUE(load_fails(file_name));
+    std::remove(file_name.c_str());
+}
+
+TEST_MAIN()
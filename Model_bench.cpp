@@ -0,0 +1,258 @@
+// Measures the cost of scoring a test set when each post is tokenized
+// once per label, as the classifier used to do, against tokenizing it
+// once and scoring every label against the same word IDs, and then the
+// portable scoring kernel against the AVX2 one and the sparse index on
+// pre-tokenized posts, then exact word IDs against hashed buckets of
+// several sizes, tokenizing included, with the memory of each model, then
+// the multinomial model of term counts, and finally the dense and sparse
+// kernels on a synthetic set of thousands of labels.
+//
+// Usage: Model_bench.exe [TRAIN_FILE [TEST_FILE]]
+
+#include "csvstream.hpp"
+#include "Model.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// EFFECTS: Returns the (tag, content) rows of a CSV file.
+vector<pair<string, string>> read_rows(const string &file_name) {
+  vector<pair<string, string>> rows;
+  csvstream csv(file_name);
+  map<string, string> row;
+  while (csv >> row) {
+    rows.emplace_back(row["tag"], row["content"]);
+  }
+  return rows;
+}
+
+// EFFECTS: Returns the IDs of the unique words of str, building a fresh
+//          set<string> as the classifier did before Tokenizer.
+vector<int> parse_ids(const Vocabulary &words, const string &str) {
+  istringstream source(str);
+  set<string> unique_words;
+  string word;
+  while (source >> word) {
+    unique_words.insert(word);
+  }
+  vector<int> ids;
+  for (const string &unique_word : unique_words) {
+    ids.push_back(words.get_id(unique_word));
+  }
+  return ids;
+}
+
+// MODIFIES: random
+// EFFECTS: Returns count rows of a synthetic set of label_count labels, as
+//          of the tags of a large forum: each post has 3 of the 4 words
+//          of its label and 10 of 3000 words that any label may use. Row i
+//          of a training set has label i % label_count, so every label
+//          has posts; a test set draws its labels at random.
+vector<pair<string, string>> synthetic_rows(int label_count, int count,
+                                            bool training, mt19937 &random) {
+  vector<pair<string, string>> rows;
+  for (int i = 0; i < count; ++i) {
+    int label = training ? i % label_count : random() % label_count;
+    string content;
+    for (int word = 0; word < 3; ++word) {
+      content += "w" + to_string(label) + "_" + to_string(random() % 4) + " ";
+    }
+    for (int word = 0; word < 10; ++word) {
+      content += "shared" + to_string(random() % 3000) + " ";
+    }
+    rows.emplace_back("tag" + to_string(label), content);
+  }
+  return rows;
+}
+
+// EFFECTS: Runs predict(i) for every test row i several times, reporting the
+//          fastest run and the number of correct predictions.
+template <typename Predict>
+void report(const string &name, const vector<pair<string, string>> &rows,
+            const Data &data, Predict predict) {
+  const int runs = 5;
+  double best_ms = 0;
+  int correct = 0;
+  for (int run = 0; run < runs; ++run) {
+    correct = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < rows.size(); ++i) {
+      int label = predict(i);
+      correct += data.get_labels().get_string(label) == rows[i].first;
+    }
+    auto stop = chrono::steady_clock::now();
+    double ms = chrono::duration<double, milli>(stop - start).count();
+    if (run == 0 || ms < best_ms) {
+      best_ms = ms;
+    }
+  }
+  cout << left << setw(20) << name << right
+       << setw(10) << best_ms << " ms"
+       << setw(10) << correct << " / " << rows.size() << " correct" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  string train_file = argc > 1 ? argv[1] : "w14-f15_instructor_student.csv";
+  string test_file = argc > 2 ? argv[2] : "w16_instructor_student.csv";
+
+  vector<pair<string, string>> train_rows = read_rows(train_file);
+  Posts training;
+  Tokenizer tokenizer;
+  for (const auto &row : train_rows) {
+    const vector<string_view> &words = tokenizer.get_unique_words(row.second);
+    training.emplace_back(row.first, vector<string_view>(words.begin(),
+                                                         words.end()));
+  }
+  vector<pair<string, string>> test_rows = read_rows(test_file);
+
+  Data data(training);
+  Model model(&data);
+  const Vocabulary &words = data.get_words();
+  int label_count = data.get_labels().size();
+
+  cout << fixed << setprecision(2);
+  cout << test_rows.size() << " test posts, " << label_count << " labels"
+       << endl;
+
+  report("tokenize per label", test_rows, data, [&](size_t i) {
+    const string &content = test_rows[i].second;
+    int best_label = 0;
+    double best = log(0);
+    for (int label = 0; label < label_count; ++label) {
+      double score = model.get_log_probability(label,
+                                               parse_ids(words, content));
+      if (score > best) {
+        best = score;
+        best_label = label;
+      }
+    }
+    return best_label;
+  });
+
+  report("tokenize once", test_rows, data, [&](size_t i) {
+    const vector<int> &ids = tokenizer.get_word_ids(words, test_rows[i].second);
+    int best_label = 0;
+    double best = log(0);
+    for (int label = 0; label < label_count; ++label) {
+      double score = model.get_log_probability(label, ids);
+      if (score > best) {
+        best = score;
+        best_label = label;
+      }
+    }
+    return best_label;
+  });
+
+  // the kernels alone, on posts tokenized in advance
+  vector<vector<int>> test_ids;
+  for (const auto &row : test_rows) {
+    test_ids.push_back(tokenizer.get_word_ids(words, row.second));
+  }
+
+  vector<double> scores;
+  report("scalar kernel", test_rows, data, [&](size_t i) {
+    return model.predict_scalar(test_ids[i], scores).label;
+  });
+
+  if (Model::has_avx2()) {
+    report("avx2 kernel", test_rows, data, [&](size_t i) {
+      return model.predict(test_ids[i], scores).label;
+    });
+  }
+
+  model.build_sparse_index();
+  cout << model.get_posting_count() << " postings for "
+       << words.size() + 1 << " word IDs" << endl;
+  report("sparse index", test_rows, data, [&](size_t i) {
+    return model.predict_sparse(test_ids[i], scores).label;
+  });
+
+  // the log-likelihood table, which dominates the size of a model
+  auto table_mib = [](const Data &data) {
+    return (data.get_words().size() + 1.0)
+           * Model::get_label_stride(data.get_labels().size())
+           * sizeof(double) / (1 << 20);
+  };
+  Model exact(&data);
+  cout << "exact: " << words.size() << " words, " << table_mib(data)
+       << " MiB" << endl;
+  report("exact words", test_rows, data, [&](size_t i) {
+    return exact.predict(tokenizer.get_word_ids(words, test_rows[i].second),
+                         scores).label;
+  });
+  for (int bits : { 10, 14, 18 }) {
+    Features features;
+    features.hash_bits = bits;
+    Data hashed_data(training, features);
+    Model hashed(&hashed_data);
+    cout << "hashed: " << bits << " bits, " << table_mib(hashed_data)
+         << " MiB" << endl;
+    report(to_string(bits) + "-bit buckets", test_rows, hashed_data,
+           [&](size_t i) {
+      return hashed.predict(
+        tokenizer.get_word_ids(hashed_data.get_words(), test_rows[i].second),
+        scores).label;
+    });
+  }
+
+  // the same words counted with their repeats, tokenizing included
+  Posts repeated;
+  for (const auto &row : train_rows) {
+    const vector<string_view> &words =
+      tokenizer.get_features(row.second, 1, true);
+    repeated.emplace_back(row.first, vector<string_view>(words.begin(),
+                                                         words.end()));
+  }
+  Features features;
+  features.term_counts = true;
+  Data multinomial_data(repeated, features);
+  Model multinomial(&multinomial_data);
+  report("multinomial", test_rows, multinomial_data, [&](size_t i) {
+    return multinomial.predict_post(tokenizer, test_rows[i].second,
+                                    scores).label;
+  });
+
+  // thousands of labels, where most (label, word) pairs never occur
+  const int many_labels = 2000;
+  mt19937 random(43);
+  vector<pair<string, string>> many_train =
+    synthetic_rows(many_labels, 4 * many_labels, true, random);
+  vector<pair<string, string>> many_test =
+    synthetic_rows(many_labels, 1000, false, random);
+  Posts many_training;
+  for (const auto &row : many_train) {
+    const vector<string_view> &words = tokenizer.get_unique_words(row.second);
+    many_training.emplace_back(row.first, vector<string_view>(words.begin(),
+                                                              words.end()));
+  }
+  Data many_data(many_training);
+  Model many(&many_data);
+  vector<vector<int>> many_ids;
+  for (const auto &row : many_test) {
+    many_ids.push_back(tokenizer.get_word_ids(many_data.get_words(),
+                                              row.second));
+  }
+  cout << many_test.size() << " synthetic test posts, " << many_labels
+       << " labels, " << many_data.get_words().size() << " words, "
+       << table_mib(many_data) << " MiB" << endl;
+  report("scalar, many labels", many_test, many_data, [&](size_t i) {
+    return many.predict_scalar(many_ids[i], scores).label;
+  });
+  if (Model::has_avx2()) {
+    report("avx2, many labels", many_test, many_data, [&](size_t i) {
+      return many.predict(many_ids[i], scores).label;
+    });
+  }
+  many.build_sparse_index();
+  cout << many.get_posting_count() << " postings for "
+       << many_data.get_words().size() + 1 << " word IDs" << endl;
+  report("sparse, many labels", many_test, many_data, [&](size_t i) {
+    return many.predict_sparse(many_ids[i], scores).label;
+  });
+}
@@ -0,0 +1,348 @@
+#include "Model.hpp"
+#include "Sweep.hpp"
+#include "unit_test_framework.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The label and content of a few training posts.
+static const std::vector<std::pair<std::string_view, std::string_view>>
+    training_rows = {
+        { "euchre", "bob is the dealer and bob calls trump" },
+        { "calculator", "countif in stack not working" },
+        { "euchre", "segfault when bob leads trump" },
+        { "recursion", "base case of the stack" },
+        { "calculator", "stack segfault in countif countif" },
+        { "recursion", "stack overflow with no base case" },
+        { "euchre", "dealer picks up trump" },
+    };
+
+// REQUIRES: keys outlives the result
+// MODIFIES: keys
+// EFFECTS : Returns the posts of rows, with their features as Tokenizer
+//           extracts them.
+static Posts make_posts(
+    const std::vector<std::pair<std::string_view, std::string_view>> &rows,
+    const Features &features, std::vector<std::string> &keys) {
+    Tokenizer tokenizer;
+    keys.assign(rows.size(), std::string());
+    Posts posts;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        posts.emplace_back(rows[i].first, tokenizer.get_features(
+            rows[i].second, features.ngram_order, features.term_counts,
+            keys[i]));
+    }
+    return posts;
+}
+
+// EFFECTS : Returns whether every log-likelihood and log-prior of
+//           expected is exactly the one of actual for the same label and
+//           word strings. actual may have more labels and words.
+static bool has_tables_of(const Model &actual, const Model &expected) {
+    const Vocabulary &labels = expected.get_labels();
+    const Vocabulary &words = expected.get_words();
+    for (int label = 0; label < labels.size(); ++label) {
+        int actual_label = actual.get_labels().get_id(labels.get_string(label));
+        if (actual.get_log_prior(actual_label) != expected.get_log_prior(label)) {
+            return false;
+        }
+        for (int word = 0; word <= words.size(); ++word) {
+            int actual_word = word == words.size()
+                ? actual.get_words().get_unknown_id()
+                : actual.get_words().get_id(words.get_string(word));
+            if (actual.get_log_likelihood(actual_label, actual_word)
+                != expected.get_log_likelihood(label, word)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// EFFECTS : Returns whether actual and expected have the same labels,
+//           words and tables, whatever their IDs.
+static bool same_tables(const Model &actual, const Model &expected) {
+    return actual.get_labels().size() == expected.get_labels().size()
+           && actual.get_words().size() == expected.get_words().size()
+           && actual.get_post_count() == expected.get_post_count()
+           && has_tables_of(actual, expected);
+}
+
+// MODIFIES: storage
+// EFFECTS : Returns rows of posts for label_count labels, posts_per_label
+//           of each, where every post has words of its own label and a
+//           few shared by all labels. The rows refer to storage.
+static std::vector<std::pair<std::string_view, std::string_view>>
+make_many_label_rows(int label_count, int posts_per_label,
+                     std::vector<std::string> &storage) {
+    storage.clear();
+    for (int label = 0; label < label_count; ++label) {
+        for (int post = 0; post < posts_per_label; ++post) {
+            storage.push_back("label" + std::to_string(label));
+            std::string content = "the and of";
+            for (int word = 0; word < 20; ++word) {
+                content += " w" + std::to_string(label) + "_"
+                           + std::to_string((word * 7 + post) % 30);
+            }
+            storage.push_back(content);
+        }
+    }
+    std::vector<std::pair<std::string_view, std::string_view>> rows;
+    for (size_t i = 0; i < storage.size(); i += 2) {
+        rows.emplace_back(storage[i], storage[i + 1]);
+    }
+    return rows;
+}
+
+TEST(test_tokenizer_unique_words) {
+    Tokenizer tokenizer;
+    std::vector<std::string_view> words =
+        tokenizer.get_unique_words("  b a\tb\n c  ");
+    ASSERT_EQUAL(words, std::vector<std::string_view>({ "a", "b", "c" }));
+
+    words = tokenizer.get_features("b a b", 1, true);
+    ASSERT_EQUAL(words, std::vector<std::string_view>({ "a", "b", "b" }));
+
+    ASSERT_TRUE(tokenizer.get_unique_words(" \t ").empty());
+}
+
+TEST(test_tokenizer_ngrams) {
+    Tokenizer tokenizer;
+    std::vector<std::string_view> words =
+        tokenizer.get_unique_words("a b a b", 2);
+    // a and b, and the keys of the bigrams "a b" and "b a"
+    ASSERT_EQUAL(words.size(), 4u);
+    int keys = 0;
+    for (std::string_view word : words) {
+        if (Tokenizer::is_ngram_key(word)) {
+            ASSERT_EQUAL(word.size(), Tokenizer::ngram_key_size);
+            ++keys;
+        }
+    }
+    ASSERT_EQUAL(keys, 2);
+}
+
+TEST(test_vocabulary_ids) {
+    Vocabulary words(std::vector<std::string_view>({ "apple", "pear" }));
+    ASSERT_EQUAL(words.size(), 2);
+    ASSERT_EQUAL(words.get_id("apple"), 0);
+    ASSERT_EQUAL(words.get_id("pear"), 1);
+    ASSERT_EQUAL(words.get_id("plum"), words.get_unknown_id());
+    ASSERT_EQUAL(words.get_string(1), "pear");
+    ASSERT_EQUAL(words.get_string(words.get_unknown_id()), "");
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQUAL(words.add("word" + std::to_string(i)), i + 2);
+    }
+    ASSERT_EQUAL(words.get_id("word57"), 59);
+    ASSERT_EQUAL(words.get_id("pear"), 1);
+}
+
+TEST(test_tokenizer_word_ids) {
+    Vocabulary words(std::vector<std::string_view>({ "a", "b" }));
+    Tokenizer tokenizer;
+    std::vector<int> ids = tokenizer.get_word_ids(words, "b z a b");
+    ASSERT_EQUAL(ids, std::vector<int>({ 0, 1, 2 }));
+    ASSERT_EQUAL(tokenizer.get_counts(), std::vector<int>({ 1, 1, 1 }));
+
+    words.set_term_counts(true);
+    ids = tokenizer.get_word_ids(words, "b z a b");
+    ASSERT_EQUAL(ids, std::vector<int>({ 0, 1, 2 }));
+    ASSERT_EQUAL(tokenizer.get_counts(), std::vector<int>({ 1, 2, 1 }));
+}
+
+TEST(test_model_kernels_agree) {
+    std::vector<std::string> keys;
+    Data data(make_posts(training_rows, Features(), keys));
+    Model model(&data);
+    Tokenizer tokenizer;
+    std::vector<double> scores;
+    for (const auto &row : training_rows) {
+        std::vector<int> words =
+            tokenizer.get_word_ids(model.get_words(), row.second);
+        Prediction prediction = model.predict(words, scores);
+        Prediction scalar = model.predict_scalar(words, scores);
+        ASSERT_EQUAL(prediction.label, scalar.label);
+        ASSERT_EQUAL(prediction.log_probability, scalar.log_probability);
+        ASSERT_EQUAL(model.get_labels().get_string(prediction.label),
+                     row.first);
+    }
+}
+
+TEST(test_observe_matches_retraining) {
+    for (const Features &features : { Features(), Features{ 0, 2, false },
+                                      Features{ 0, 1, true } }) {
+        for (double alpha : { 0.0, 0.5 }) {
+            std::vector<std::string> all_keys;
+            Data all(make_posts(training_rows, features, all_keys));
+            Model retrained(&all, alpha);
+
+            // the first three posts, then the rest observed one at a time
+            std::vector<std::string> keys;
+            Data data(make_posts(
+                { training_rows.begin(), training_rows.begin() + 3 },
+                features, keys));
+            Model model(&data, alpha);
+            Tokenizer tokenizer;
+            for (size_t i = 3; i < training_rows.size(); ++i) {
+                data.observe(training_rows[i].first, tokenizer.get_features(
+                    training_rows[i].second, features.ngram_order,
+                    features.term_counts));
+                if (i == 4) {
+                    model.update(&data);
+                }
+            }
+            model.update(&data);
+            ASSERT_TRUE(same_tables(model, retrained));
+        }
+    }
+}
+
+TEST(test_top_k_matches_sorting_every_label) {
+    std::vector<std::string> storage;
+    std::vector<std::pair<std::string_view, std::string_view>> rows =
+        make_many_label_rows(40, 3, storage);
+    std::vector<std::string> keys;
+    Data data(make_posts(rows, Features(), keys));
+    for (double alpha : { 0.0, 1.0 }) {
+        Model model(&data, alpha);
+        Tokenizer tokenizer;
+        Pruning_stats stats;
+        for (const auto &row : rows) {
+            std::vector<int> words =
+                tokenizer.get_word_ids(model.get_words(), row.second);
+            std::vector<Prediction> all;
+            for (int label = 0; label < model.get_label_count(); ++label) {
+                all.push_back(Prediction{
+                    label, model.get_log_probability(label, words) });
+            }
+            std::sort(all.begin(), all.end(),
+                      [](const Prediction &a, const Prediction &b) {
+                          return a.log_probability > b.log_probability
+                              || (a.log_probability == b.log_probability
+                                  && a.label < b.label);
+                      });
+            for (int k : { 1, 5, 40, 50 }) {
+                std::vector<Prediction> top =
+                    model.predict_top_k(words, k, stats);
+                ASSERT_EQUAL(top.size(), size_t(std::min(k, 40)));
+                for (size_t i = 0; i < top.size(); ++i) {
+                    ASSERT_EQUAL(top[i].label, all[i].label);
+                    ASSERT_EQUAL(top[i].log_probability,
+                                 all[i].log_probability);
+                }
+            }
+        }
+        ASSERT_TRUE(stats.pruned_labels > 0);
+        ASSERT_TRUE(stats.additions < stats.full_additions);
+    }
+}
+
+TEST(test_sparse_matches_dense_with_many_labels) {
+    std::vector<std::string> storage;
+    std::vector<std::pair<std::string_view, std::string_view>> rows =
+        make_many_label_rows(300, 2, storage);
+    std::vector<std::string> keys;
+    Data data(make_posts(rows, Features(), keys));
+    for (double alpha : { 0.0, 1.0 }) {
+        Model model(&data, alpha);
+        Tokenizer tokenizer;
+        std::vector<double> scores;
+        std::vector<std::string> posts;
+        for (const auto &row : rows) {
+            posts.emplace_back(row.second);
+        }
+        // words of several labels, and words never seen in training
+        posts.push_back("w3_1 w3_8 w7_1 w250_2 unseen the");
+        posts.push_back("unseen words only");
+        posts.push_back("");
+
+        std::vector<Prediction> dense;
+        for (const std::string &post : posts) {
+            dense.push_back(model.predict(
+                tokenizer.get_word_ids(model.get_words(), post), scores));
+        }
+        model.build_sparse_index();
+        ASSERT_TRUE(model.get_posting_count()
+                    < uint64_t(model.get_label_count())
+                      * (model.get_words().size() + 1));
+        for (size_t i = 0; i < posts.size(); ++i) {
+            Prediction sparse = model.predict_sparse(
+                tokenizer.get_word_ids(model.get_words(), posts[i]), scores);
+            ASSERT_EQUAL(sparse.label, dense[i].label);
+            ASSERT_ALMOST_EQUAL(sparse.log_probability,
+                                dense[i].log_probability,
+                                1e-9 * std::fabs(dense[i].log_probability));
+        }
+    }
+}
+
+TEST(test_folds_match_training_on_their_posts) {
+    const size_t fold_count = 3;
+    ThreadPool pool(2);
+    for (const Features &features : { Features(), Features{ 0, 2, false },
+                                      Features{ 0, 1, true } }) {
+        for (double alpha : { 0.0, 0.5 }) {
+            std::vector<std::string> all_keys;
+            Posts posts = make_posts(training_rows, features, all_keys);
+            Data all(posts, pool, features);
+            std::vector<Data> folds = all.get_folds(posts, fold_count, pool);
+            for (size_t fold = 0; fold < fold_count; ++fold) {
+                std::vector<std::pair<std::string_view, std::string_view>>
+                    rows;
+                for (size_t i = 0; i < training_rows.size(); ++i) {
+                    if (i % fold_count != fold) {
+                        rows.push_back(training_rows[i]);
+                    }
+                }
+                std::vector<std::string> keys;
+                Data separate(make_posts(rows, features, keys), features);
+                ASSERT_EQUAL(folds[fold].get_seen_word_count(),
+                             separate.get_words().size());
+                Model fold_model(&folds[fold], alpha);
+                Model separate_model(&separate, alpha);
+                ASSERT_TRUE(has_tables_of(fold_model, separate_model));
+            }
+        }
+    }
+}
+
+TEST(test_sweep_matches_a_model_per_alpha) {
+    ThreadPool pool(2);
+    std::vector<double> alphas = { 0, 0.1, 1, 5 };
+    for (const Features &features : { Features(), Features{ 0, 1, true },
+                                      Features{ 4, 1, false } }) {
+        std::vector<std::string> keys;
+        Data data(make_posts(training_rows, features, keys), features);
+        Smoothing_sweep sweep(data, alphas, pool);
+        std::vector<std::pair<std::string, std::string>> posts;
+        for (const auto &row : training_rows) {
+            posts.emplace_back(row.first, row.second);
+        }
+        posts.emplace_back("euchre", "unseen bob stack stack trump");
+        std::vector<int> correct = sweep.count_correct(posts, pool);
+
+        Tokenizer tokenizer;
+        std::vector<double> scores;
+        std::vector<int> labels;
+        for (size_t a = 0; a < alphas.size(); ++a) {
+            Model model(&data, alphas[a]);
+            int model_correct = 0;
+            for (const auto &post : posts) {
+                const std::vector<int> &words =
+                    tokenizer.get_word_ids(data.get_words(), post.second);
+                sweep.predict(words, tokenizer.get_counts(), scores, labels);
+                Prediction prediction =
+                    model.predict(words, tokenizer.get_counts(), scores);
+                ASSERT_EQUAL(labels[a], prediction.label);
+                model_correct += model.get_labels().get_string(
+                    prediction.label) == post.first;
+            }
+            ASSERT_EQUAL(correct[a], model_correct);
+        }
+    }
+}
+
+TEST_MAIN()
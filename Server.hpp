@@ -0,0 +1,362 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+/* Server.hpp
+ *
+ * A long-lived classification server for a trained Model. Each request
+ * is one line holding the content of a post, and each reply is one line
+ * holding the predicted label and its log-probability score, separated
+ * by a tab. Replies on a connection come in the order of its requests.
+ *
+ * Requests are read either from a pair of file descriptors, such as
+ * stdin and stdout, or from clients of a Unix domain socket. Every
+ * request that has arrived by the time the server is free is scored as
+ * one batch on the thread pool, so requests that arrive together share
+ * one pass over the pool. The latency of every request, from reading it
+ * to writing its reply, is kept for print_latencies.
+ */
+
+#include "Model.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>  //min, sort
+#include <cerrno>     //errno, EINTR
+#include <chrono>     //steady_clock
+#include <csignal>    //sig_atomic_t
+#include <cstring>    //strerror, strncpy
+#include <exception>
+#include <map>        //map
+#include <ostream>    //ostream
+#include <sstream>    //ostringstream
+#include <string>     //string
+#include <vector>     //vector
+#include <poll.h>       //poll
+#include <sys/socket.h> //socket, bind, listen, accept, send
+#include <sys/time.h>   //timeval
+#include <sys/un.h>     //sockaddr_un
+#include <unistd.h>     //read, write, close, unlink
+
+// A custom exception type
+class server_exception : public std::exception {
+public:
+  const char * what () const noexcept override {
+    return msg.c_str();
+  }
+  const std::string msg;
+  server_exception(const std::string &msg) : msg(msg) {};
+};
+
+class Server {
+public:
+  // REQUIRES: model and pool outlive this Server
+  Server(const Model &model, ThreadPool &pool)
+    : model(model), pool(pool), batch_count(0) { }
+
+  // MODIFIES: in_fd, out_fd
+  // EFFECTS : Answers the requests read from in_fd on out_fd until the
+  //           end of the input or until stop() is called. A last line
+  //           without a newline is answered too.
+  void serve_stream(int in_fd, int out_fd) {
+    Connection connection = { in_fd, out_fd, "", false };
+    while (!stopping()) {
+      if (!wait_readable(connection.in_fd)) {
+        continue;
+      }
+      std::vector<Request> batch;
+      bool open = read_requests(connection, 0, batch);
+      // take whatever else has already arrived into the same batch
+      while (open && batch.size() < max_batch
+             && readable_now(connection.in_fd)) {
+        open = read_requests(connection, 0, batch);
+      }
+      if (!open) {
+        take_last_line(connection, 0, batch);
+      }
+      answer(batch, &connection);
+      if (!open) {
+        return;
+      }
+    }
+  }
+
+  // EFFECTS : Listens on a Unix domain socket at path, replacing any file
+  //           there, and answers the requests of every client that
+  //           connects until stop() is called. A last line without a
+  //           newline is answered before its client is closed, so a
+  //           client that shuts down its writing side still gets the
+  //           reply. A client that stops reading its replies is dropped
+  //           once a write to it has made no progress for a while, so it
+  //           cannot hold up the others. Removes the socket file when
+  //           done. Throws server_exception if the socket cannot be set up.
+  void serve_socket(const std::string &path) {
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+      throw server_exception("Socket path is too long: " + path);
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0
+        || bind(listener, reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) != 0
+        || listen(listener, SOMAXCONN) != 0) {
+      std::string error = std::strerror(errno);
+      if (listener >= 0) {
+        close(listener);
+      }
+      throw server_exception("Error listening on " + path + ": " + error);
+    }
+
+    std::vector<Connection> connections;
+    while (!stopping()) {
+      std::vector<pollfd> fds(1, pollfd{ listener, POLLIN, 0 });
+      for (const Connection &connection : connections) {
+        fds.push_back(pollfd{ connection.in_fd, POLLIN, 0 });
+      }
+      if (poll(fds.data(), fds.size(), -1) <= 0) {
+        continue;
+      }
+
+      // a client accepted now has no entry in fds until the next poll
+      size_t polled = fds.size() - 1;
+      if (fds[0].revents & POLLIN) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client >= 0) {
+          timeval timeout = { send_timeout_ms / 1000,
+                              send_timeout_ms % 1000 * 1000 };
+          setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                     sizeof(timeout));
+          connections.push_back(Connection{ client, client, "", false });
+        }
+      }
+
+      std::vector<Request> batch;
+      std::vector<bool> open(connections.size(), true);
+      for (size_t i = 0; i < polled; ++i) {
+        if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+          open[i] = read_requests(connections[i], i, batch);
+          if (!open[i]) {
+            take_last_line(connections[i], i, batch);
+          }
+        }
+      }
+      answer(batch, connections.data());
+
+      // drop the clients that hung up or stopped reading, keeping the
+      // order of the rest
+      size_t kept = 0;
+      for (size_t i = 0; i < connections.size(); ++i) {
+        if (open[i] && !connections[i].write_failed) {
+          connections[kept++] = connections[i];
+        }
+        else {
+          close(connections[i].in_fd);
+        }
+      }
+      connections.resize(kept);
+    }
+
+    for (const Connection &connection : connections) {
+      close(connection.in_fd);
+    }
+    close(listener);
+    unlink(path.c_str());
+  }
+
+  // EFFECTS : Prints the number of requests and batches answered and
+  //           percentiles of their latency.
+  void print_latencies(std::ostream &os) const {
+    os << "served " << latencies.size() << " requests in " << batch_count
+       << " batches" << std::endl;
+    if (latencies.empty()) {
+      return;
+    }
+    std::vector<double> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+    os << "latency (us): p50 = " << percentile(sorted, 50)
+       << ", p90 = " << percentile(sorted, 90)
+       << ", p99 = " << percentile(sorted, 99)
+       << ", max = " << sorted.back() << std::endl;
+  }
+
+  // EFFECTS : Makes every running serve_ call return soon. Safe to call
+  //           from a signal handler.
+  static void stop() {
+    stop_flag() = 1;
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  // most requests scored in one batch from a stream
+  static const size_t max_batch = 4096;
+  // longest a write to a socket client may block before it is dropped
+  static const int send_timeout_ms = 1000;
+
+  // A line of content waiting for its reply
+  struct Request {
+    // index of the connection to reply on
+    size_t connection;
+    std::string content;
+    clock::time_point arrival;
+  };
+
+  struct Connection {
+    int in_fd;
+    int out_fd;
+    // input after the last complete line
+    std::string pending;
+    // whether a reply could not be written in full
+    bool write_failed;
+  };
+
+  const Model &model;
+  ThreadPool &pool;
+  // microseconds from reading each request to writing its reply
+  std::vector<double> latencies;
+  size_t batch_count;
+
+  static volatile std::sig_atomic_t &stop_flag() {
+    static volatile std::sig_atomic_t flag = 0;
+    return flag;
+  }
+
+  static bool stopping() {
+    return stop_flag() != 0;
+  }
+
+  // EFFECTS : Waits until fd has input or is closed. Returns false if the
+  //           wait was interrupted, for example by a signal.
+  static bool wait_readable(int fd, int timeout_ms = -1) {
+    pollfd request = { fd, POLLIN, 0 };
+    return poll(&request, 1, timeout_ms) > 0;
+  }
+
+  static bool readable_now(int fd) {
+    return wait_readable(fd, 0);
+  }
+
+  // MODIFIES: connection, batch
+  // EFFECTS : Reads what is available on the connection and adds every
+  //           complete line to batch as a request. Returns false once the
+  //           connection has reached the end of its input.
+  static bool read_requests(Connection &connection, size_t index,
+                            std::vector<Request> &batch) {
+    char buffer[65536];
+    ssize_t count = read(connection.in_fd, buffer, sizeof(buffer));
+    if (count < 0) {
+      return errno == EINTR;
+    }
+    if (count == 0) {
+      return false;
+    }
+    clock::time_point arrival = clock::now();
+    connection.pending.append(buffer, count);
+
+    size_t start = 0;
+    for (size_t end = connection.pending.find('\n'); end != std::string::npos;
+         end = connection.pending.find('\n', start)) {
+      size_t length = end - start;
+      if (length > 0 && connection.pending[end - 1] == '\r') {
+        --length;
+      }
+      batch.push_back(Request{ index, connection.pending.substr(start, length),
+                               arrival });
+      start = end + 1;
+    }
+    connection.pending.erase(0, start);
+    return true;
+  }
+
+  // MODIFIES: connection, batch
+  // EFFECTS : Adds the input after the last complete line of a connection
+  //           that has reached the end of its input to batch as a request,
+  //           unless there is none.
+  static void take_last_line(Connection &connection, size_t index,
+                             std::vector<Request> &batch) {
+    if (!connection.pending.empty()) {
+      batch.push_back(Request{ index, connection.pending, clock::now() });
+      connection.pending.clear();
+    }
+  }
+
+  // MODIFIES: connections, latencies
+  // EFFECTS : Scores the batch on the pool, writes the replies to each
+  //           connection in request order, and records the latencies.
+  //           Marks the connections whose replies could not be written.
+  void answer(const std::vector<Request> &batch, Connection *connections) {
+    if (batch.empty()) {
+      return;
+    }
+    const size_t chunk_size = 64;
+    std::vector<Prediction> predictions(batch.size());
+    pool.run((batch.size() + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+      Tokenizer tokenizer;
+      std::vector<double> scores;
+      size_t end = std::min(batch.size(), (chunk + 1) * chunk_size);
+      for (size_t i = chunk * chunk_size; i < end; ++i) {
+        predictions[i] = model.predict_post(tokenizer, batch[i].content,
+                                            scores);
+      }
+    });
+
+    std::map<size_t, std::string> replies;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      std::ostringstream reply;
+      reply.precision(3);
+      reply << model.get_labels().get_string(predictions[i].label) << '\t'
+            << predictions[i].log_probability << '\n';
+      replies[batch[i].connection] += reply.str();
+    }
+    for (const auto &reply : replies) {
+      Connection &connection = connections[reply.first];
+      if (!write_all(connection.out_fd, reply.second)) {
+        connection.write_failed = true;
+      }
+    }
+
+    clock::time_point done = clock::now();
+    for (const Request &request : batch) {
+      latencies.push_back(std::chrono::duration<double, std::micro>(
+        done - request.arrival).count());
+    }
+    ++batch_count;
+  }
+
+  // EFFECTS : Writes all of text to fd and returns true, or returns false
+  //           if the other end has gone away or a send timed out.
+  static bool write_all(int fd, const std::string &text) {
+    size_t written = 0;
+    while (written < text.size()) {
+      ssize_t count = send_or_write(fd, text.data() + written,
+                                    text.size() - written);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        return false;
+      }
+      written += count;
+    }
+    return true;
+  }
+
+  // EFFECTS : Sends to a socket without raising SIGPIPE if the client has
+  //           hung up, or writes to any other kind of file descriptor.
+  static ssize_t send_or_write(int fd, const char *data, size_t size) {
+    ssize_t count = send(fd, data, size, MSG_NOSIGNAL);
+    if (count < 0 && errno == ENOTSOCK) {
+      count = write(fd, data, size);
+    }
+    return count;
+  }
+
+  // REQUIRES: sorted is sorted and not empty
+  // EFFECTS : Returns the nearest-rank percentile of sorted.
+  static double percentile(const std::vector<double> &sorted, int percent) {
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+  }
+};
+
+#endif // SERVER_HPP
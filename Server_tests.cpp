@@ -0,0 +1,229 @@
+#include "Server.hpp"
+#include "unit_test_framework.hpp"
+#include <csignal>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// EFFECTS : Returns a few training posts.
+static Posts make_posts() {
+    return Posts({
+        { "euchre", { "bob", "dealer", "trump" } },
+        { "euchre", { "bob", "segfault", "trump" } },
+        { "calculator", { "countif", "segfault", "stack" } },
+        { "calculator", { "countif", "function", "stack" } },
+    });
+}
+
+// EFFECTS : Returns the reply line the server should give for content.
+static std::string expected_reply(const Model &model,
+                                  std::string_view content) {
+    Tokenizer tokenizer;
+    std::vector<double> scores;
+    Prediction prediction = model.predict_post(tokenizer, content, scores);
+    std::ostringstream reply;
+    reply.precision(3);
+    reply << model.get_labels().get_string(prediction.label) << '\t'
+          << prediction.log_probability << '\n';
+    return reply.str();
+}
+
+// EFFECTS : Reads from fd until the end of its input.
+static std::string read_all(int fd) {
+    std::string text;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, count);
+    }
+    return text;
+}
+
+// EFFECTS : Reads from fd up to and including the next newline, or until
+//           the end of its input.
+static std::string read_line(int fd) {
+    std::string line;
+    char c;
+    while (read(fd, &c, 1) == 1) {
+        line += c;
+        if (c == '\n') {
+            break;
+        }
+    }
+    return line;
+}
+
+// EFFECTS : Starts serving model on a Unix domain socket at path in a
+//           child process, so that stopping it leaves this one as is, and
+//           returns the ID of the child.
+static pid_t start_server(const Model &model, const std::string &path) {
+    // writing to a server that died fails the test instead of killing it
+    signal(SIGPIPE, SIG_IGN);
+    unlink(path.c_str());
+    pid_t child = fork();
+    if (child == 0) {
+        ThreadPool pool(1);
+        Server server(model, pool);
+        server.serve_socket(path);
+        _exit(0);
+    }
+    return child;
+}
+
+// EFFECTS : Stops the server started by start_server.
+static void stop_server(pid_t child, const std::string &path) {
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    unlink(path.c_str());
+}
+
+// EFFECTS : Connects to the server at path, waiting for it to start, and
+//           returns the socket, or -1 if the server never came up.
+static int connect_client(const std::string &path) {
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        if (connect(client, reinterpret_cast<sockaddr *>(&address),
+                    sizeof(address)) == 0) {
+            return client;
+        }
+        usleep(10000);
+    }
+    close(client);
+    return -1;
+}
+
+TEST(test_stream_answers_last_line) {
+    Data data(make_posts());
+    Model model(&data);
+    ThreadPool pool(2);
+    int in[2];
+    int out[2];
+    ASSERT_EQUAL(pipe(in), 0);
+    ASSERT_EQUAL(pipe(out), 0);
+    std::string input = "bob deals trump\r\ncountif stack\nsegfault in stack";
+    ASSERT_EQUAL(write(in[1], input.data(), input.size()),
+                 ssize_t(input.size()));
+    close(in[1]);
+
+    Server server(model, pool);
+    server.serve_stream(in[0], out[1]);
+    close(in[0]);
+    close(out[1]);
+    ASSERT_EQUAL(read_all(out[0]),
+                 expected_reply(model, "bob deals trump")
+                 + expected_reply(model, "countif stack")
+                 + expected_reply(model, "segfault in stack"));
+    close(out[0]);
+}
+
+TEST(test_socket_answers_last_line) {
+    Data data(make_posts());
+    Model model(&data);
+    const std::string path = "Server_tests.sock";
+    pid_t child = start_server(model, path);
+    ASSERT_TRUE(child >= 0);
+    int client = connect_client(path);
+    ASSERT_TRUE(client >= 0);
+
+    // a complete line, then one the client ends by shutting down writing
+    std::string input = "countif stack\nbob deals trump";
+    ASSERT_EQUAL(write(client, input.data(), input.size()),
+                 ssize_t(input.size()));
+    shutdown(client, SHUT_WR);
+    std::string replies = read_all(client);
+    close(client);
+    stop_server(child, path);
+
+    ASSERT_EQUAL(replies, expected_reply(model, "countif stack")
+                          + expected_reply(model, "bob deals trump"));
+}
+
+TEST(test_socket_client_joins_while_another_is_served) {
+    Data data(make_posts());
+    Model model(&data);
+    const std::string path = "Server_tests.sock";
+    pid_t child = start_server(model, path);
+    ASSERT_TRUE(child >= 0);
+    int first = connect_client(path);
+    ASSERT_TRUE(first >= 0);
+    std::string input = "countif stack\n";
+    ASSERT_EQUAL(write(first, input.data(), input.size()),
+                 ssize_t(input.size()));
+    std::string first_replies = read_line(first);
+
+    // the first client's next request and the second client's connection
+    // arrive together
+    input = "bob deals trump\n";
+    ASSERT_EQUAL(write(first, input.data(), input.size()),
+                 ssize_t(input.size()));
+    int second = connect_client(path);
+    ASSERT_TRUE(second >= 0);
+    input = "segfault in stack\n";
+    ASSERT_EQUAL(write(second, input.data(), input.size()),
+                 ssize_t(input.size()));
+    first_replies += read_line(first);
+    std::string second_replies = read_line(second);
+
+    input = "stack";
+    ASSERT_EQUAL(write(first, input.data(), input.size()),
+                 ssize_t(input.size()));
+    shutdown(first, SHUT_WR);
+    shutdown(second, SHUT_WR);
+    first_replies += read_all(first);
+    second_replies += read_all(second);
+    close(first);
+    close(second);
+    stop_server(child, path);
+
+    ASSERT_EQUAL(first_replies, expected_reply(model, "countif stack")
+                                + expected_reply(model, "bob deals trump")
+                                + expected_reply(model, "stack"));
+    ASSERT_EQUAL(second_replies, expected_reply(model, "segfault in stack"));
+}
+
+TEST(test_socket_drops_client_that_stops_reading) {
+    Data data(make_posts());
+    Model model(&data);
+    const std::string path = "Server_tests.sock";
+    pid_t child = start_server(model, path);
+    ASSERT_TRUE(child >= 0);
+
+    // send requests until the socket is full, never reading the replies,
+    // which are larger than the requests
+    int stuck = connect_client(path);
+    ASSERT_TRUE(stuck >= 0);
+    fcntl(stuck, F_SETFL, O_NONBLOCK);
+    std::string input(4096, '\n');
+    for (int i = 0; i < 1000; ++i) {
+        if (write(stuck, input.data(), input.size()) <= 0) {
+            break;
+        }
+    }
+
+    // another client is still answered, instead of waiting forever
+    int client = connect_client(path);
+    ASSERT_TRUE(client >= 0);
+    timeval timeout = { 10, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    input = "countif stack\n";
+    ASSERT_EQUAL(write(client, input.data(), input.size()),
+                 ssize_t(input.size()));
+    std::string reply = read_line(client);
+    close(client);
+    close(stuck);
+    stop_server(child, path);
+
+    ASSERT_EQUAL(reply, expected_reply(model, "countif stack"));
+}
+
+TEST_MAIN()
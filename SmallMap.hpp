@@ -0,0 +1,292 @@
+#ifndef SMALL_MAP_HPP
+#define SMALL_MAP_HPP
+/* SmallMap.hpp
+ *
+ * A Map for collections that are usually tiny, such as the words of a
+ * single post or the labels of one dataset. Up to N elements are kept
+ * inline, in a sorted array inside the SmallMap itself, so building and
+ * searching a small SmallMap never touches the heap. Inserting an
+ * element beyond the first N moves all of them into a Map, which is
+ * used from then on.
+ *
+ * SmallMap has the same interface as Map, except for the tree-specific
+ * operations (merge, split, join, extract and the parallel traversals).
+ */
+
+#include "Map.hpp"
+#include <algorithm> //lower_bound, move_backward
+#include <cassert>   //assert
+#include <new>       //placement new
+#include <utility>   //pair, move
+
+template <typename Key_type, typename Value_type, size_t N,
+          typename Key_compare=std::less<Key_type> // default argument
+         >
+class SmallMap {
+
+  static_assert(N > 0, "SmallMap needs room for at least one element");
+
+private:
+  using Pair_type = std::pair<Key_type, Value_type>;
+  using Tree_map = Map<Key_type, Value_type, Key_compare>;
+
+public:
+
+  class Iterator {
+    // OVERVIEW: Iterator over the elements of a SmallMap in ascending key
+    //           order. While the SmallMap is inline, inserting an element
+    //           invalidates its Iterators, as for std::vector.
+
+  public:
+    Iterator()
+      : element(nullptr), spilled(false) { }
+
+    // EFFECTS:  Returns the current element by reference. The key must
+    //           not be modified.
+    Pair_type &operator*() const {
+      return spilled ? *tree_it : *element;
+    }
+
+    // EFFECTS:  Returns the current element by pointer.
+    Pair_type *operator->() const {
+      return &**this;
+    }
+
+    // Prefix ++
+    Iterator &operator++() {
+      if (spilled) {
+        ++tree_it;
+      }
+      else {
+        ++element;
+      }
+      return *this;
+    }
+
+    // Postfix ++ (implemented in terms of prefix ++)
+    Iterator operator++(int) {
+      Iterator result(*this);
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const Iterator &rhs) const {
+      return spilled ? tree_it == rhs.tree_it : element == rhs.element;
+    }
+
+    bool operator!=(const Iterator &rhs) const {
+      return !(*this == rhs);
+    }
+
+  private:
+    friend class SmallMap;
+
+    Pair_type *element;
+    typename Tree_map::Iterator tree_it;
+    bool spilled;
+
+    explicit Iterator(Pair_type *element_in)
+      : element(element_in), spilled(false) { }
+
+    explicit Iterator(typename Tree_map::Iterator tree_it_in)
+      : element(nullptr), tree_it(tree_it_in), spilled(true) { }
+
+  }; // SmallMap::Iterator
+  ////////////////////////////////////////
+
+  // Default constructor
+  SmallMap()
+    : count(0), spilled(false) { }
+
+  // Copy constructor
+  SmallMap(const SmallMap &other)
+    : count(0), spilled(other.spilled), tree(other.tree) {
+    for (const Pair_type &element : other.inline_elements()) {
+      new (data() + count) Pair_type(element);
+      ++count;
+    }
+  }
+
+  // Move constructor
+  // (Moves the elements of other, leaving it empty)
+  SmallMap(SmallMap &&other)
+    : count(0), spilled(other.spilled), tree(std::move(other.tree)) {
+    for (Pair_type &element : other.inline_elements()) {
+      new (data() + count) Pair_type(std::move(element));
+      ++count;
+    }
+    other.clear();
+  }
+
+  // Assignment operator (copy and move)
+  SmallMap &operator=(SmallMap rhs) {
+    clear();
+    spilled = rhs.spilled;
+    tree = std::move(rhs.tree);
+    for (Pair_type &element : rhs.inline_elements()) {
+      new (data() + count) Pair_type(std::move(element));
+      ++count;
+    }
+    return *this;
+  }
+
+  // Destructor
+  ~SmallMap() {
+    clear();
+  }
+
+  // EFFECTS : Returns whether this SmallMap is empty.
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // EFFECTS : Returns the number of elements in this SmallMap.
+  size_t size() const {
+    return spilled ? tree.size() : count;
+  }
+
+  // EFFECTS : Returns whether the elements are still stored inline,
+  //           i.e. this SmallMap has never held more than N elements.
+  bool is_inline() const {
+    return !spilled;
+  }
+
+  // EFFECTS : Searches this SmallMap for an element with a key equivalent
+  //           to k and returns an Iterator to it if found, otherwise
+  //           returns an end Iterator. Inline elements are binary searched.
+  Iterator find(const Key_type &k) const {
+    if (spilled) {
+      return Iterator(tree.find(k));
+    }
+    Pair_type *position = lower_bound(k);
+    if (position != data() + count && !less(k, position->first)) {
+      return Iterator(position);
+    }
+    return end();
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Returns a reference to the mapped value for the given key,
+  //           first inserting an element with that key and a
+  //           value-initialized mapped value if there is none.
+  Value_type &operator[](const Key_type &k) {
+    Iterator found = find(k);
+    if (found == end()) {
+      found = insert(Pair_type(k, Value_type())).first;
+    }
+    return found->second;
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Inserts the given element if its key is not already in this
+  //           SmallMap. Returns an Iterator to the element with that key,
+  //           along with whether the element was inserted.
+  std::pair<Iterator, bool> insert(const Pair_type &val) {
+    return insert(Pair_type(val));
+  }
+
+  // MODIFIES: this, val
+  // EFFECTS : Same as insert(const Pair_type &), but moves val into the
+  //           SmallMap instead of copying it.
+  std::pair<Iterator, bool> insert(Pair_type &&val) {
+    if (!spilled && count == N && find(val.first) == end()) {
+      spill();
+    }
+    if (spilled) {
+      std::pair<typename Tree_map::Iterator, bool> result =
+        tree.insert(std::move(val));
+      return std::pair<Iterator, bool>(Iterator(result.first),
+                                       result.second);
+    }
+
+    Pair_type *position = lower_bound(val.first);
+    Pair_type *last = data() + count;
+    if (position != last && !less(val.first, position->first)) {
+      return std::pair<Iterator, bool>(Iterator(position), false);
+    }
+    if (position == last) {
+      new (last) Pair_type(std::move(val));
+    }
+    else {
+      // Shift the greater elements up by one to make room
+      new (last) Pair_type(std::move(*(last - 1)));
+      std::move_backward(position, last - 1, last);
+      *position = std::move(val);
+    }
+    ++count;
+    return std::pair<Iterator, bool>(Iterator(position), true);
+  }
+
+  // EFFECTS : Returns an iterator to the first key-value pair.
+  Iterator begin() const {
+    return spilled ? Iterator(tree.begin()) : Iterator(data());
+  }
+
+  // EFFECTS : Returns an iterator to "past-the-end".
+  Iterator end() const {
+    return spilled ? Iterator(tree.end()) : Iterator(data() + count);
+  }
+
+private:
+  // Raw, suitably aligned storage for N inline elements, of which the
+  // first 'count' are constructed and sorted by key
+  alignas(Pair_type) unsigned char storage[N * sizeof(Pair_type)];
+  size_t count;
+  bool spilled;
+  Tree_map tree;
+  Key_compare less;
+
+  // A view of the constructed inline elements, for range-for loops
+  struct Inline_elements {
+    Pair_type *first;
+    Pair_type *last;
+    Pair_type *begin() const { return first; }
+    Pair_type *end() const { return last; }
+  };
+
+  Pair_type *data() const {
+    return reinterpret_cast<Pair_type *>(
+      const_cast<unsigned char *>(storage));
+  }
+
+  Inline_elements inline_elements() const {
+    return Inline_elements{ data(), data() + count };
+  }
+
+  // EFFECTS : Returns the first inline element whose key is not less
+  //           than k, or one past the last inline element.
+  Pair_type *lower_bound(const Key_type &k) const {
+    return std::lower_bound(data(), data() + count, k,
+      [this](const Pair_type &element, const Key_type &key) {
+        return less(element.first, key);
+      });
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Destroys the inline elements and empties the tree.
+  void clear() {
+    for (Pair_type &element : inline_elements()) {
+      element.~Pair_type();
+    }
+    count = 0;
+    spilled = false;
+    tree = Tree_map();
+  }
+
+  // MODIFIES: this
+  // EFFECTS : Moves the inline elements into the tree. They are already
+  //           sorted, so each is appended with end() as the hint, and the
+  //           tree is rebalanced once at the end.
+  void spill() {
+    assert(!spilled);
+    for (Pair_type &element : inline_elements()) {
+      tree.insert(tree.end(), std::move(element));
+      element.~Pair_type();
+    }
+    tree.rebalance();
+    count = 0;
+    spilled = true;
+  }
+};
+
+#endif // SMALL_MAP_HPP
@@ -0,0 +1,110 @@
+#include "SmallMap.hpp"
+#include "unit_test_framework.hpp"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+TEST(test_empty) {
+    SmallMap<string, double, 4> words;
+    ASSERT_TRUE(words.empty());
+    ASSERT_EQUAL(words.size(), 0u);
+    ASSERT_TRUE(words.is_inline());
+    ASSERT_TRUE(words.begin() == words.end());
+    ASSERT_TRUE(words.find("hello") == words.end());
+}
+
+TEST(test_inline_sorted) {
+    SmallMap<string, double, 4> words;
+    words["world"] = 2;
+    words["hello"] = 1;
+    ASSERT_TRUE(words.insert({"pi", 3.14159}).second);
+    ASSERT_FALSE(words.insert({"pi", 0}).second);
+
+    ASSERT_EQUAL(words.size(), 3u);
+    ASSERT_TRUE(words.is_inline());
+    ASSERT_EQUAL(words["pi"], 3.14159);
+    ASSERT_EQUAL(words.find("world")->second, 2);
+    ASSERT_TRUE(words.find("zebra") == words.end());
+
+    vector<string> keys;
+    for (auto &p : words) {
+        keys.push_back(p.first);
+    }
+    ASSERT_EQUAL(keys, vector<string>({"hello", "pi", "world"}));
+}
+
+TEST(test_spill) {
+    SmallMap<int, int, 3> squares;
+    for (int key = 9; key >= 0; --key) {
+        squares[key] = key * key;
+        ASSERT_EQUAL(squares.is_inline(), key >= 7);
+    }
+
+    ASSERT_EQUAL(squares.size(), 10u);
+    ASSERT_EQUAL(squares[7], 49);
+    ASSERT_FALSE(squares.insert({7, 0}).second);
+
+    int expected_key = 0;
+    for (auto &p : squares) {
+        ASSERT_EQUAL(p.first, expected_key);
+        ASSERT_EQUAL(p.second, expected_key * expected_key);
+        ++expected_key;
+    }
+    ASSERT_EQUAL(expected_key, 10);
+}
+
+TEST(test_spill_moves) {
+    // unique_ptr cannot be copied, so spilling must move every element
+    SmallMap<int, std::unique_ptr<int>, 2> owners;
+    for (int key = 0; key < 5; ++key) {
+        owners[key].reset(new int(key * 10));
+    }
+
+    ASSERT_FALSE(owners.is_inline());
+    ASSERT_EQUAL(owners.size(), 5u);
+    for (auto &p : owners) {
+        ASSERT_TRUE(p.second != nullptr);
+        ASSERT_EQUAL(*p.second, p.first * 10);
+    }
+}
+
+TEST(test_full_but_existing_key) {
+    SmallMap<int, int, 2> map;
+    map[1] = 1;
+    map[2] = 2;
+    // an existing key does not spill a full SmallMap
+    ASSERT_FALSE(map.insert({2, 5}).second);
+    ASSERT_TRUE(map.is_inline());
+}
+
+TEST(test_copy_and_move) {
+    SmallMap<string, int, 2> small;
+    small["b"] = 2;
+    small["a"] = 1;
+
+    SmallMap<string, int, 2> big(small);
+    big["c"] = 3;
+    ASSERT_TRUE(small.is_inline());
+    ASSERT_FALSE(big.is_inline());
+    ASSERT_EQUAL(small.size(), 2u);
+    ASSERT_EQUAL(big.size(), 3u);
+
+    SmallMap<string, int, 2> moved(std::move(big));
+    ASSERT_TRUE(big.empty());
+    ASSERT_EQUAL(moved["c"], 3);
+
+    moved = small;
+    ASSERT_TRUE(moved.is_inline());
+    ASSERT_EQUAL(moved.size(), 2u);
+    ASSERT_EQUAL(moved["a"], 1);
+
+    small = std::move(moved);
+    ASSERT_EQUAL(small.size(), 2u);
+    ASSERT_EQUAL(small.begin()->first, "a");
+}
+
+TEST_MAIN()
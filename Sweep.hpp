@@ -0,0 +1,142 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+/* Sweep.hpp
+ *
+ * Scoring one test set under several smoothing parameters at once. The
+ * training posts are counted once into a Data, and a single table holds
+ * the log-likelihoods of every (word, label) pair for every alpha side by
+ * side, so each test post is tokenized once and each of its words adds one
+ * contiguous row into a score matrix of labels by alphas.
+ *
+ * The scores for each alpha are those of a Model built from the same Data
+ * with that alpha, added in the same order, so the accuracy reported for
+ * an alpha is exactly the accuracy of training with it.
+ */
+
+#include "Model.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>  //min
+#include <cmath>      //log
+#include <string>     //string
+#include <utility>    //pair
+#include <vector>     //vector
+
+class Smoothing_sweep {
+public:
+  // REQUIRES: data outlives this Smoothing_sweep, and every alpha >= 0
+  // EFFECTS : Computes the log-likelihood tables of data for every alpha,
+  //           a chunk of rows at a time on the threads of pool.
+  Smoothing_sweep(const Data &data, const std::vector<double> &alphas,
+                  ThreadPool &pool)
+    : data(data), alphas(alphas), label_count(data.get_labels().size()),
+      row_size(label_count * alphas.size()) {
+    double post_count = data.get_post_count();
+    for (int label = 0; label < label_count; ++label) {
+      log_prior.push_back(
+        std::log(data.get_label_frequency(label)/post_count));
+    }
+
+    int word_count = data.get_words().size();
+    log_likelihood.resize((word_count + 1) * row_size);
+    const int chunk_size = 256;
+    pool.run(word_count / chunk_size + 1, [&](size_t chunk) {
+      int end = std::min<int>(word_count + 1, (chunk + 1) * chunk_size);
+      for (int word = chunk * chunk_size; word < end; ++word) {
+        for (int label = 0; label < label_count; ++label) {
+          for (size_t a = 0; a < alphas.size(); ++a) {
+            log_likelihood[word * row_size + label * alphas.size() + a] =
+              Model::get_smoothed_log_likelihood(data, label, word, alphas[a]);
+          }
+        }
+      }
+    });
+  }
+
+  const std::vector<double> & get_alphas() const {
+    return alphas;
+  }
+
+  // REQUIRES: every element of words is a word ID of the Data or its
+  //           unknown word ID, occurring counts[i] times, as given by
+  //           Tokenizer::get_counts
+  // MODIFIES: scores, labels
+  // EFFECTS : Sets labels[a] to the label predicted for a post with the
+  //           given words under alphas[a], with ties going to the lowest
+  //           label ID as in Model::predict. scores is scratch space.
+  void predict(const std::vector<int> &words, const std::vector<int> &counts,
+               std::vector<double> &scores, std::vector<int> &labels) const {
+    size_t alpha_count = alphas.size();
+    scores.resize(row_size);
+    for (int label = 0; label < label_count; ++label) {
+      for (size_t a = 0; a < alpha_count; ++a) {
+        scores[label * alpha_count + a] = log_prior[label];
+      }
+    }
+    for (size_t w = 0; w < words.size(); ++w) {
+      const double *row = &log_likelihood[words[w] * row_size];
+      double count = counts[w];
+      for (size_t i = 0; i < row_size; ++i) {
+        scores[i] += count * row[i];
+      }
+    }
+
+    labels.assign(alpha_count, 0);
+    for (size_t a = 0; a < alpha_count; ++a) {
+      double best = std::log(0);
+      for (int label = 0; label < label_count; ++label) {
+        if (scores[label * alpha_count + a] > best) {
+          best = scores[label * alpha_count + a];
+          labels[a] = label;
+        }
+      }
+    }
+  }
+
+  // EFFECTS : Returns, for every alpha, how many of the (label, content)
+  //           posts are predicted correctly. The posts are tokenized and
+  //           scored in chunks on the threads of pool.
+  std::vector<int> count_correct(
+    const std::vector<std::pair<std::string, std::string>> &posts,
+    ThreadPool &pool) const {
+    const size_t chunk_size = 256;
+    size_t chunk_count = (posts.size() + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<int>> chunk_correct(
+      chunk_count, std::vector<int>(alphas.size(), 0));
+    pool.run(chunk_count, [&](size_t chunk) {
+      Tokenizer tokenizer;
+      std::vector<double> scores;
+      std::vector<int> labels;
+      size_t end = std::min(posts.size(), (chunk + 1) * chunk_size);
+      for (size_t i = chunk * chunk_size; i < end; ++i) {
+        predict(tokenizer.get_word_ids(data.get_words(), posts[i].second),
+                tokenizer.get_counts(), scores, labels);
+        for (size_t a = 0; a < alphas.size(); ++a) {
+          if (data.get_labels().get_string(labels[a]) == posts[i].first) {
+            chunk_correct[chunk][a] += 1;
+          }
+        }
+      }
+    });
+
+    std::vector<int> correct(alphas.size(), 0);
+    for (const std::vector<int> &counts : chunk_correct) {
+      for (size_t a = 0; a < alphas.size(); ++a) {
+        correct[a] += counts[a];
+      }
+    }
+    return correct;
+  }
+
+private:
+  const Data &data;
+  std::vector<double> alphas;
+  int label_count;
+  // labels times alphas
+  size_t row_size;
+  std::vector<double> log_prior;
+  // at [(word * label_count + label) * alphas.size() + alpha index],
+  // including the row of the unknown word ID
+  std::vector<double> log_likelihood;
+};
+
+#endif // SWEEP_HPP
@@ -0,0 +1,185 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+/* ThreadPool.hpp
+ *
+ * A fixed set of worker threads that run batches of indexed tasks.
+ * This is the executor used by the parallel Map operations and by the
+ * classifier's training and prediction. Any type with a run(count, task)
+ * member that behaves like ThreadPool::run can be used as an executor
+ * instead.
+ */
+
+#include <algorithm>          //max
+#include <atomic>             //atomic
+#include <condition_variable> //condition_variable
+#include <cstddef>            //size_t
+#include <exception>          //exception_ptr
+#include <functional>         //function
+#include <mutex>              //mutex
+#include <thread>             //thread
+#include <vector>             //vector
+
+class ThreadPool {
+public:
+  // EFFECTS : Returns the number of threads the hardware can run at once,
+  //           or 1 if that is unknown.
+  static size_t hardware_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // EFFECTS : Creates a pool that runs tasks on num_threads threads in
+  //           total, counting the thread that calls run(). A pool of one
+  //           thread runs every task on the calling thread.
+  explicit ThreadPool(size_t num_threads = hardware_threads())
+    : generation(0), stopping(false), busy_workers(0) {
+    for (size_t i = 1; i < num_threads; ++i) {
+      workers.emplace_back([this]() { work(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake_workers.notify_all();
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+  }
+
+  // EFFECTS : Returns the number of threads that run tasks.
+  size_t size() const {
+    return workers.size() + 1;
+  }
+
+  // MODIFIES: whatever task modifies
+  // EFFECTS : Calls task(i) once for every i in [0, count), spread over
+  //           the threads of this pool, and returns when all calls have
+  //           finished. If any call throws, rethrows the first exception
+  //           after the others have finished.
+  // NOTE    : Calls from inside a task (nested parallelism) run serially
+  //           on the calling thread, since all workers are already busy.
+  template <typename Task>
+  void run(size_t count, Task task) {
+    if (workers.empty() || inside_task() || count <= 1) {
+      for (size_t i = 0; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> batch_lock(run_mutex);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job = [&task](size_t i) { task(i); };
+      job_size = count;
+      next_index = 0;
+      error = nullptr;
+      busy_workers = workers.size();
+      ++generation;
+    }
+    wake_workers.notify_all();
+
+    run_tasks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    batch_done.wait(lock, [this]() { return busy_workers == 0; });
+    job = nullptr;
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // REQUIRES: parts is not empty
+  // MODIFIES: parts, whatever merge modifies
+  // EFFECTS : Combines all of parts into parts[0] by calling
+  //           merge(into, from) on pairs of parts in a balanced tree, and
+  //           leaves parts with that single element. The merges of each
+  //           level of the tree run in parallel. A part is only ever
+  //           merged into the part before it, so for an associative merge
+  //           the result is the same as merging from left to right.
+  template <typename T, typename Merge>
+  void reduce(std::vector<T> &parts, Merge merge) {
+    for (size_t stride = 1; stride < parts.size(); stride *= 2) {
+      // merge parts[i + stride] into parts[i] for i = 0, 2 * stride, ...
+      size_t pairs = (parts.size() - stride + 2 * stride - 1) / (2 * stride);
+      run(pairs, [&parts, &merge, stride](size_t pair) {
+        merge(parts[2 * stride * pair], parts[2 * stride * pair + stride]);
+      });
+    }
+    parts.erase(parts.begin() + 1, parts.end());
+  }
+
+private:
+  std::vector<std::thread> workers;
+
+  // Guards everything below except next_index
+  std::mutex mutex;
+  // Serializes concurrent calls to run() from different threads
+  std::mutex run_mutex;
+  std::condition_variable wake_workers;
+  std::condition_variable batch_done;
+
+  std::function<void(size_t)> job;
+  size_t job_size = 0;
+  std::atomic<size_t> next_index{0};
+  std::exception_ptr error;
+  unsigned long generation;
+  bool stopping;
+  size_t busy_workers;
+
+  // EFFECTS : Returns a reference to the flag that marks the current
+  //           thread as running a task.
+  static bool &inside_task() {
+    thread_local bool inside = false;
+    return inside;
+  }
+
+  // EFFECTS : Claims and runs tasks of the current batch until none are
+  //           left, recording the first exception thrown.
+  void run_tasks() {
+    inside_task() = true;
+    for (size_t i = next_index++; i < job_size; i = next_index++) {
+      try {
+        job(i);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    inside_task() = false;
+  }
+
+  // EFFECTS : Body of every worker thread: waits for a new batch, helps
+  //           run it, and reports when it is done.
+  void work() {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      wake_workers.wait(lock, [&]() {
+        return stopping || generation != seen;
+      });
+      if (stopping) {
+        return;
+      }
+      seen = generation;
+
+      lock.unlock();
+      run_tasks();
+      lock.lock();
+
+      if (--busy_workers == 0) {
+        batch_done.notify_one();
+      }
+    }
+  }
+};
+
+#endif // THREAD_POOL_HPP
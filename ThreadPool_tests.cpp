@@ -0,0 +1,88 @@
+#include "ThreadPool.hpp"
+#include "unit_test_framework.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(test_run_every_index_once) {
+    ThreadPool pool(4);
+    ASSERT_EQUAL(pool.size(), 4u);
+
+    std::vector<int> hits(1000, 0);
+    pool.run(hits.size(), [&](size_t i) { hits[i] += 1; });
+
+    for (int hit : hits) {
+        ASSERT_EQUAL(hit, 1);
+    }
+}
+
+TEST(test_run_repeatedly) {
+    ThreadPool pool(3);
+    std::atomic<int> total(0);
+    for (int batch = 0; batch < 100; ++batch) {
+        pool.run(10, [&](size_t i) { total += static_cast<int>(i); });
+    }
+    ASSERT_EQUAL(total.load(), 100 * 45);
+}
+
+TEST(test_single_thread) {
+    ThreadPool pool(1);
+    ASSERT_EQUAL(pool.size(), 1u);
+
+    std::vector<size_t> order;
+    pool.run(5, [&](size_t i) { order.push_back(i); });
+    ASSERT_EQUAL(order, std::vector<size_t>({0, 1, 2, 3, 4}));
+}
+
+TEST(test_nested_run) {
+    ThreadPool pool(4);
+    std::atomic<int> total(0);
+    pool.run(4, [&](size_t) {
+        pool.run(10, [&](size_t) { total += 1; });
+    });
+    ASSERT_EQUAL(total.load(), 40);
+}
+
+TEST(test_exception) {
+    ThreadPool pool(4);
+    std::atomic<int> finished(0);
+    bool caught = false;
+    try {
+        pool.run(100, [&](size_t i) {
+            if (i == 50) {
+                throw std::runtime_error("task failed");
+            }
+            finished += 1;
+        });
+    }
+    catch (const std::runtime_error &) {
+        caught = true;
+    }
+    ASSERT_TRUE(caught);
+    ASSERT_EQUAL(finished.load(), 99);
+
+    // the pool is still usable
+    pool.run(10, [&](size_t) { finished += 1; });
+    ASSERT_EQUAL(finished.load(), 109);
+}
+
+TEST(test_reduce) {
+    ThreadPool pool(4);
+    for (size_t size = 1; size <= 9; ++size) {
+        // string concatenation is associative but not commutative
+        std::vector<std::string> parts;
+        std::string expected;
+        for (size_t i = 0; i < size; ++i) {
+            parts.push_back(std::string(1, char('a' + i)));
+            expected += parts.back();
+        }
+        pool.reduce(parts, [](std::string &into, std::string &from) {
+            into += from;
+        });
+        ASSERT_EQUAL(parts.size(), 1u);
+        ASSERT_EQUAL(parts[0], expected);
+    }
+}
+
+TEST_MAIN()
@@ -1,277 +1,834 @@
-#include "csvstream.hpp"
-#include <iostream>
-#include <string>
-#include <map>
-#include <math.h>
-#include <set>
-
-using namespace std;
-
-class Data
-{
-private:
-    int post_count;
-    set<string> unique_words;
-    map<pair<string, string>, double> post_label_word_frequency;
-    map<string, double> post_label_frequency;
-    map<string, double> post_word_frequency;
-
-public:
-    // constructor
-    Data(const vector<pair<string, set<string>>> &data_vector)
-    : post_count(data_vector.size())
-    {
-        set_unique_words(data_vector);
-        count_label_word_frequency(data_vector);
-    }
-
-    // data mutators
-    void set_unique_words(const vector<pair<string, set<string>>> &data_vector)
-    {
-        for (const auto &item : data_vector)
-        {
-            for (const auto &word : item.second)
-            {
-                unique_words.insert(word);
-            }
-        }
-    }
-
-    void count_label_word_frequency(const vector<pair<string, set<string>>> &data_vector)
-    {
-        for (const auto &post : data_vector) {
-            post_label_frequency[post.first] += 1;
-
-            for (const auto &word : post.second) {
-                post_label_word_frequency[pair(post.first, word)] += 1;
-                post_word_frequency[word] += 1;
-            }
-        }
-    }
-
-    // accessors
-    int get_post_count() const
-    {
-        return post_count;
-    }
-
-    set<string> & get_unique_words()
-    {
-        return unique_words;
-    }
-
-    map<pair<string, string>, double> & get_label_word_frequency()
-    {
-        return post_label_word_frequency;
-    }
-
-    map<string, double> & get_label_frequency()
-    {
-        return post_label_frequency;
-    }
-
-    map<string, double> & get_word_frequency()
-    {
-        return post_word_frequency;
-    }
-};
-
-class Classifier {
-private:
-    vector<pair<string, string>> unadjusted_vector;
-    vector<pair<string, set<string>>> adjusted_vector;
-
-    // probability vars
-    double current_log_probability;
-    double max_log_probability;
-    string predicated_label;
-    int correct_predictions;
-
-public:
-    // constructor
-    Classifier (const vector<pair<string, string>> &data_vector, 
-                const vector<pair<string, string>> &test_data_vector, int mode) 
-    : unadjusted_vector(data_vector), current_log_probability(0), 
-      max_log_probability(log(0)), correct_predictions(0)
-    {
-        adjust_vector(data_vector);
-        Data *data = new Data(adjusted_vector);
-
-        if (mode == 4) {
-            print_training_data();
-            print_training_post_count(data);
-            print_vocab_size(data);
-            print_classes(data);
-            print_classifier_params(data);
-        }
-        else if (mode == 3) {
-            print_training_post_count(data);
-        }
-        cout << "\ntest data:" << endl;
-
-        for (const auto &post_X : test_data_vector) {
-            max_log_probability = log(0);
-            for (const auto &C : data->get_label_frequency()) {
-                Calculate_C_Prob(data, C.first, get_parsed_string(post_X.second));
-                if (current_log_probability > max_log_probability) {
-                    max_log_probability = current_log_probability;
-                    predicated_label = C.first;
-                }
-            }
-            if (predicated_label == post_X.first) {
-                correct_predictions += 1;
-            }
-            cout << "  correct = " << post_X.first << ", predicted = " 
-                 << predicated_label << ", log-probability score = " 
-                 << max_log_probability << endl; 
-            cout << "  content = " << post_X.second << "\n" << endl;
-        }
-        cout << "performance: " << correct_predictions << " / " 
-             << test_data_vector.size()
-             << " posts predicted correctly" << endl;
-
-        delete data;
-    }
-
-    // probability functions
-    void Calculate_C_Prob(Data *data, const string &label, const set<string> &content) {
-        current_log_probability = get_log_prior(data, label);
-        for (const string &word : content) {
-            current_log_probability += get_log_likelihood(data, label, word);
-        }
-    }
-
-    double get_log_likelihood(Data *data, const string &label, const string &word) {
-        if (data->get_word_frequency().find(word) == data->get_word_frequency().end()) {
-            return log(1.0/data->get_post_count());
-        }
-        else if (data->get_label_word_frequency().find(pair(label, word)) 
-                 == data->get_label_word_frequency().end()) {
-            return log(data->get_word_frequency()[word]/data->get_post_count());
-        }
-        else {
-            return log(data->get_label_word_frequency()[pair(label, word)]
-                   / data->get_label_frequency()[label]);
-        }
-    }
-
-    double get_log_prior(Data *data, string label) {
-        return log(data->get_label_frequency()[label]/data->get_post_count());
-    }
-
-    // helper data functions
-    void adjust_vector(const vector<pair<string, string>> &vec) {
-        set<string> words_in_content;
-
-        for (const auto &post : vec) {
-            words_in_content.clear();
-
-            string tag = post.first;
-            string content = post.second;
-            istringstream source(content);
-            string word;
-
-            while (source >> word) {
-                words_in_content.insert(word);
-            }
-
-            pair<string, set<string>> value(tag, words_in_content);
-            adjusted_vector.push_back(pair(tag, words_in_content));
-        }
-    }
-
-    // EFFECTS: Return a set of unique whitespace delimited words.x
-    set<string> get_parsed_string(const string &str) {
-        istringstream source(str);
-        set<string> words;
-        string word;
-        while (source >> word) {
-            words.insert(word);
-        }
-        return words;
-    }
-
-    void print_training_data() {
-        cout << "training data:" << endl;
-        for (const auto &post : unadjusted_vector) {
-            cout << "  label = " << post.first << ", content = " << post.second << endl;
-        }
-    }
-
-    void print_training_post_count(Data *data) {
-        cout << "trained on " << data->get_post_count() << " examples" << endl;
-    }
-
-    void print_vocab_size(Data *data) {
-        cout << "vocabulary size = " << data->get_unique_words().size() << "\n" << endl;
-    }
-
-    void print_classes(Data *data) {
-        cout << "classes:" << endl;
-        for (const auto &label : data->get_label_frequency())
-        cout << "  " << label.first << ", " << label.second 
-             << " examples, log-prior = " << get_log_prior(data, label.first) << endl;
-    }
-
-    void print_classifier_params(Data *data) {
-        cout << "classifier parameters:" << endl;
-        for (const auto &lw : data->get_label_word_frequency()) {
-            cout << "  " <<lw.first.first << ":" << lw.first.second
-                 << ", count = " << lw.second << ", log-likelihood = "
-                 << get_log_likelihood(data, lw.first.first, lw.first.second) << endl;
-        }
-    }
-};
-
-
-int main(int argc, char * argv[]) {
-    cout.precision(3);
-    string debug = "--debug";
-
-    if (argc == 4) {
-        if (argv[3] != debug) {
-            cout << "Usage: main.exe TRAIN_FILE TEST_FILE [--debug]" << endl;
-            return -1;
-        }
-    }
-
-    if (argc != 3 && argc != 4) { //checks for correct # of arguments
-        cout << "Usage: main.exe TRAIN_FILE TEST_FILE [--debug]" << endl;
-        return -1;
-    }
-
-    string train_file_name = argv[1];
-    string test_file_name = argv[2];
-
-    vector<pair<string, string>> train_rows;
-    vector<pair<string, string>> test_rows;
-    
-    try {
-        csvstream train_csv(train_file_name);
-        map<string, string> train_row;
-        while (train_csv >> train_row) {
-            //cout << row["tag"] << ": " << row["content"] << endl;
-            pair<string, string> new_row(train_row["tag"], train_row["content"]);
-            train_rows.push_back(new_row);
-        }
-    } 
-    catch (const csvstream_exception &e) {
-        cout << "Error opening file: " << train_file_name << endl;
-        return -1;
-    }
-
-    try {
-        csvstream test_csv(test_file_name);
-        map<string, string> test_row;
-        while (test_csv >> test_row) {
-            pair<string, string> new_row(test_row["tag"], test_row["content"]);
-            test_rows.push_back(new_row);
-        }
-    } 
-    catch (const csvstream_exception &e) {
-        cout << "Error opening file: " << test_file_name << endl;
-        return -1;
-    }
-
-    Classifier classy(train_rows, test_rows, argc);
+#include "csvstream.hpp"
+#include "Metrics.hpp"
+#include "Model.hpp"
+#include "ModelFile.hpp"
+#include "Server.hpp"
+#include "Sweep.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// command line options after TRAIN_FILE and TEST_FILE
+struct Options
+{
+    bool debug = false;
+    // number of threads that train and score
+    int threads = 1;
+    // model file to write after training, if any
+    string save_model;
+    // model file to score with instead of training, if any
+    string load_model;
+    // keep training on rows appended to the training file
+    bool follow = false;
+    // answer classification requests instead of scoring a test file
+    bool serve = false;
+    // Unix domain socket to serve on; stdin and stdout if empty
+    string socket;
+    // if positive, also list the top_k best labels of each test post
+    int top_k = 0;
+    // score with the sparse index of the model
+    bool sparse = false;
+    // if positive, cross-validate on this many folds of the training file
+    // instead of scoring a test file
+    int cv = 0;
+    // additive smoothing of the likelihoods; 0 keeps the fallback rules
+    double alpha = 0;
+    // if not empty, report the test accuracy of training with each of
+    // these alphas instead of scoring with one model
+    vector<double> sweep;
+    // if positive, count words in 2^hash_bits hash buckets
+    int hash_bits = 0;
+    // also use the n-grams of 2 .. ngrams words as features
+    int ngrams = 1;
+    // count repeated words, for a multinomial model
+    bool multinomial = false;
+    // print a confusion matrix and the metrics of every label
+    bool metrics = false;
+    // CSV file to write the confusion matrix and metrics to, if any
+    string metrics_csv;
+};
+
+// MODIFIES: alphas
+// EFFECTS: Parses a comma-separated list of alphas, optionally prefixed
+//          with "alpha=", into alphas. Returns false unless every alpha is
+//          a number >= 0.
+bool parse_alphas(string text, vector<double> &alphas) {
+    const string prefix = "alpha=";
+    if (text.compare(0, prefix.size(), prefix) == 0) {
+        text.erase(0, prefix.size());
+    }
+    istringstream source(text);
+    string item;
+    while (getline(source, item, ',')) {
+        char *end = nullptr;
+        double alpha = strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || !(alpha >= 0)) {
+            return false;
+        }
+        alphas.push_back(alpha);
+    }
+    return !alphas.empty();
+}
+
+// Signal handler that shuts down a running Server
+void stop_server(int) {
+    Server::stop();
+}
+
+// Set by stop_following to end --follow
+volatile sig_atomic_t following_stopped = 0;
+
+// Signal handler that ends --follow once its current update is printed
+void stop_following(int) {
+    following_stopped = 1;
+}
+
+// Reads a CSV file that is still being appended to, such as a training
+// file that grows as more posts are labeled. Each call to read_rows
+// returns the rows added since the previous call.
+class Csv_follower {
+private:
+    string file_name;
+    // the header line, to parse later rows with
+    string header;
+    // bytes of the file read so far
+    streamoff offset;
+
+public:
+    // constructor
+    Csv_follower(const string &file_name)
+    : file_name(file_name), offset(0) { }
+
+    // EFFECTS: Returns the (tag, content) of every complete row added to
+    //          the file since the last call; the first call returns every
+    //          row. A row is complete once its newline has been written.
+    //          Throws csvstream_exception if the file cannot be read.
+    vector<pair<string, string>> read_rows() {
+        ifstream file(file_name, ios::binary);
+        if (!file) {
+            throw csvstream_exception("Error opening file: " + file_name);
+        }
+        file.seekg(offset);
+        string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        vector<pair<string, string>> rows;
+        size_t end = text.rfind('\n');
+        if (end == string::npos) {
+            return rows;
+        }
+        text.resize(end + 1);
+        offset += text.size();
+        if (header.empty()) {
+            header = text.substr(0, text.find('\n') + 1);
+            text.erase(0, header.size());
+        }
+
+        istringstream source(header + text);
+        csvstream csv(source);
+        map<string, string> row;
+        while (csv >> row) {
+            rows.push_back(pair<string, string>(row["tag"], row["content"]));
+        }
+        return rows;
+    }
+};
+
+class Classifier {
+private:
+    vector<pair<string, string>> unadjusted_vector;
+    // views of the words of unadjusted_vector and of their n-gram keys
+    Posts adjusted_vector;
+    // the n-gram keys of each training post
+    vector<string> ngram_keys;
+
+    int correct_predictions;
+
+public:
+    // constructor
+    // follower is the source of rows appended to the training file, which
+    // is only used with options.follow
+    Classifier (const vector<pair<string, string>> &data_vector, 
+                const vector<pair<string, string>> &test_data_vector, 
+                const Options &options, Csv_follower *follower = nullptr) 
+    : unadjusted_vector(data_vector), correct_predictions(0)
+    {
+        ThreadPool pool(options.threads);
+        if (options.cv > 0) {
+            Data data = train(options, pool);
+            print_features(options, data);
+            cross_validate(data, options, pool);
+            return;
+        }
+        if (!options.sweep.empty()) {
+            Data data = train(options, pool);
+            print_features(options, data);
+            sweep(data, options.sweep, test_data_vector, pool);
+            return;
+        }
+        // declared first, so the model that views it is destroyed first
+        unique_ptr<Data> owned_data;
+        unique_ptr<Model> owned_model;
+        if (options.load_model.empty()) {
+            owned_data.reset(new Data(train(options, pool)));
+            owned_model.reset(new Model(owned_data.get(), options.alpha));
+            if (!options.save_model.empty()) {
+                save_model(options.save_model, *owned_data, *owned_model);
+            }
+        }
+        else {
+            owned_model.reset(new Model(load_model(options.load_model)));
+            if ((options.top_k > 0 || options.sparse) 
+                && owned_model->get_words().has_term_counts()) {
+                throw model_file_exception(
+                    "Error: " + options.load_model + " has term counts, "
+                    "which --top-k and --sparse do not support");
+            }
+        }
+        Data *data = owned_data.get();
+        Model *model = owned_model.get();
+        if (options.sparse) {
+            model->build_sparse_index(pool);
+        }
+        if (options.serve) {
+            serve(model, options.socket, pool);
+            return;
+        }
+        const Vocabulary &labels = model->get_labels();
+
+        if (options.debug) {
+            print_training_data();
+            print_training_post_count(model);
+            print_vocab_size(data);
+            print_classes(data, model);
+            print_classifier_params(data, model);
+        }
+        else {
+            print_training_post_count(model);
+            if (data) {
+                print_features(options, *data);
+            }
+        }
+        cout << "\ntest data:" << endl;
+
+        vector<vector<Prediction>> top_predictions;
+        Pruning_stats pruning;
+        vector<Prediction> predictions = options.top_k > 0
+            ? predict_top_k_all(model, test_data_vector, options.top_k, pool, 
+                                top_predictions, pruning)
+            : predict_all(model, test_data_vector, pool);
+        for (size_t i = 0; i < test_data_vector.size(); ++i) {
+            const auto &post_X = test_data_vector[i];
+            string_view predicted = labels.get_string(predictions[i].label);
+            if (predicted == post_X.first) {
+                correct_predictions += 1;
+            }
+            cout << "  correct = " << post_X.first << ", predicted = " 
+                 << predicted << ", log-probability score = " 
+                 << predictions[i].log_probability << endl; 
+            if (options.top_k > 0) {
+                print_top_predictions(model, top_predictions[i]);
+            }
+            cout << "  content = " << post_X.second << "\n" << endl;
+        }
+        cout << "performance: " << correct_predictions << " / " 
+             << test_data_vector.size()
+             << " posts predicted correctly" << endl;
+        if (options.top_k > 0) {
+            print_pruning_stats(pruning);
+        }
+        if (options.metrics || !options.metrics_csv.empty()) {
+            print_metrics(options, labels, Confusion_matrix::count(
+                labels, test_data_vector, predictions, pool));
+        }
+
+        if (options.follow) {
+            follow(follower, data, model, test_data_vector, pool);
+        }
+    }
+
+    // EFFECTS: Answers classification requests with model, on the given
+    //          Unix domain socket or else on stdin and stdout, until the
+    //          input ends or the program is interrupted. Then prints the
+    //          request latencies to cerr.
+    void serve(const Model *model, const string &socket_path, ThreadPool &pool) {
+        Server server(*model, pool);
+        signal(SIGINT, stop_server);
+        signal(SIGTERM, stop_server);
+        if (socket_path.empty()) {
+            server.serve_stream(STDIN_FILENO, STDOUT_FILENO);
+        }
+        else {
+            server.serve_socket(socket_path);
+        }
+        server.print_latencies(cerr);
+    }
+
+    // REQUIRES: data was built from adjusted_vector
+    // EFFECTS: Scores every training post with a model trained on the
+    //          options.cv folds it is not in, as given by Data::get_folds,
+    //          and prints the accuracy of each fold and of all of them. The
+    //          folds are built and scored in parallel on pool.
+    void cross_validate(const Data &data, const Options &options, 
+                        ThreadPool &pool) {
+        int fold_count = options.cv;
+        vector<Data> folds = data.get_folds(adjusted_vector, fold_count, pool);
+        vector<int> correct(fold_count, 0);
+        vector<int> total(fold_count, 0);
+        // every fold counts its posts into its own matrix
+        vector<Confusion_matrix> matrices(
+            fold_count, Confusion_matrix(data.get_labels().size()));
+        pool.run(fold_count, [&](size_t fold) {
+            Model model(&folds[fold], options.alpha);
+            if (options.sparse) {
+                model.build_sparse_index();
+            }
+            Tokenizer tokenizer;
+            vector<double> scores;
+            for (size_t i = fold; i < unadjusted_vector.size(); i += fold_count) {
+                Prediction prediction = model.predict_post(
+                    tokenizer, unadjusted_vector[i].second, scores);
+                if (model.get_labels().get_string(prediction.label) 
+                    == unadjusted_vector[i].first) {
+                    correct[fold] += 1;
+                }
+                total[fold] += 1;
+                matrices[fold].add(
+                    model.get_labels().get_id(unadjusted_vector[i].first), 
+                    prediction.label);
+            }
+        });
+
+        int all_correct = 0;
+        for (int fold = 0; fold < fold_count; ++fold) {
+            cout << "fold " << fold + 1 << ": trained on " 
+                 << folds[fold].get_post_count() << " examples, " 
+                 << correct[fold] << " / " << total[fold] 
+                 << " posts predicted correctly" << endl;
+            all_correct += correct[fold];
+        }
+        cout << "cross-validation: " << all_correct << " / " 
+             << unadjusted_vector.size() << " posts predicted correctly (" 
+             << 100.0 * all_correct / unadjusted_vector.size() << "%)" << endl;
+        if (options.metrics || !options.metrics_csv.empty()) {
+            pool.reduce(matrices, [](Confusion_matrix &into, 
+                                     const Confusion_matrix &from) {
+                into.merge(from);
+            });
+            print_metrics(options, data.get_labels(), matrices[0]);
+        }
+    }
+
+    // EFFECTS: Prints the confusion matrix and metrics if options.metrics,
+    //          and writes them to options.metrics_csv if it is set. Throws
+    //          csvstream_exception if that file cannot be written.
+    void print_metrics(const Options &options, const Vocabulary &labels, 
+                       const Confusion_matrix &matrix) {
+        if (options.metrics) {
+            matrix.print_text(cout, labels);
+        }
+        if (!options.metrics_csv.empty()) {
+            ofstream csv(options.metrics_csv);
+            matrix.print_csv(csv, labels);
+            if (!csv) {
+                throw csvstream_exception("Error writing file: " 
+                                          + options.metrics_csv);
+            }
+        }
+    }
+
+    // EFFECTS: Prints how many test posts are predicted correctly when
+    //          training on data with each of alphas, and the best alpha,
+    //          the first of those with the most.
+    void sweep(const Data &data, const vector<double> &alphas, 
+               const vector<pair<string, string>> &test_data_vector, 
+               ThreadPool &pool) {
+        Smoothing_sweep sweep(data, alphas, pool);
+        vector<int> correct = sweep.count_correct(test_data_vector, pool);
+        size_t best = 0;
+        for (size_t a = 0; a < alphas.size(); ++a) {
+            cout << "alpha = " << alphas[a] << ": " << correct[a] << " / " 
+                 << test_data_vector.size() << " posts predicted correctly" 
+                 << endl;
+            if (correct[a] > correct[best]) {
+                best = a;
+            }
+        }
+        cout << "best alpha = " << alphas[best] << endl;
+    }
+
+    // MODIFIES: data, model
+    // EFFECTS: Polls the training file for new rows until the program is
+    //          interrupted. Each batch of new rows is counted into data,
+    //          the model is updated with the changes, and the test posts
+    //          are scored again, printing the new training and performance
+    //          counts. Returns once SIGINT or SIGTERM is received.
+    void follow(Csv_follower *follower, Data *data, Model *model, 
+                const vector<pair<string, string>> &test_data_vector, 
+                ThreadPool &pool) {
+        signal(SIGINT, stop_following);
+        signal(SIGTERM, stop_following);
+        Tokenizer tokenizer;
+        while (!following_stopped) {
+            // wait in short steps, since sleep_for resumes after a signal
+            for (int waited = 0; waited < follow_poll_ms && !following_stopped; 
+                 waited += follow_wait_ms) {
+                this_thread::sleep_for(chrono::milliseconds(follow_wait_ms));
+            }
+            if (following_stopped) {
+                break;
+            }
+            vector<pair<string, string>> rows = follower->read_rows();
+            if (rows.empty()) {
+                continue;
+            }
+            for (const auto &row : rows) {
+                data->observe(row.first, tokenizer.get_features(
+                    row.second, data->get_words().get_ngram_order(), 
+                    data->get_words().has_term_counts()));
+            }
+            model->update(data);
+
+            vector<Prediction> predictions = 
+                predict_all(model, test_data_vector, pool);
+            int correct = 0;
+            for (size_t i = 0; i < test_data_vector.size(); ++i) {
+                if (model->get_labels().get_string(predictions[i].label) 
+                    == test_data_vector[i].first) {
+                    correct += 1;
+                }
+            }
+            cout << "\n";
+            print_training_post_count(model);
+            cout << "performance: " << correct << " / " 
+                 << test_data_vector.size()
+                 << " posts predicted correctly" << endl;
+        }
+    }
+
+    // EFFECTS: Returns the prediction for every post, in the order of
+    //          posts. The posts are scored in chunks on the threads of pool,
+    //          each chunk with its own Tokenizer; every result goes to its
+    //          own slot, so the output does not depend on the thread count.
+    vector<Prediction> predict_all(const Model *model, 
+                                   const vector<pair<string, string>> &posts, 
+                                   ThreadPool &pool) {
+        vector<Prediction> predictions(posts.size());
+        pool.run((posts.size() + chunk_size - 1) / chunk_size, 
+                 [&](size_t chunk) {
+            Tokenizer tokenizer;
+            vector<double> scores;
+            size_t end = min(posts.size(), (chunk + 1) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+                predictions[i] = model->predict_post(tokenizer, 
+                                                     posts[i].second, scores);
+            }
+        });
+        return predictions;
+    }
+
+    // MODIFIES: top_predictions, pruning
+    // EFFECTS: Like predict_all, but also fills top_predictions with the
+    //          top k labels of every post, found with Model::predict_top_k,
+    //          and adds the work that took to pruning. Returns the best
+    //          label of every post.
+    vector<Prediction> predict_top_k_all(const Model *model, 
+                                         const vector<pair<string, string>> &posts, 
+                                         int k, ThreadPool &pool, 
+                                         vector<vector<Prediction>> &top_predictions, 
+                                         Pruning_stats &pruning) {
+        size_t chunk_count = (posts.size() + chunk_size - 1) / chunk_size;
+        top_predictions.assign(posts.size(), vector<Prediction>());
+        vector<Pruning_stats> chunk_pruning(chunk_count);
+        pool.run(chunk_count, [&](size_t chunk) {
+            Tokenizer tokenizer;
+            size_t end = min(posts.size(), (chunk + 1) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+                top_predictions[i] = model->predict_top_k(
+                    tokenizer.get_word_ids(model->get_words(), posts[i].second), 
+                    k, chunk_pruning[chunk]);
+            }
+        });
+
+        // a Model trained on no posts has no labels to rank
+        vector<Prediction> predictions;
+        for (const vector<Prediction> &top : top_predictions) {
+            predictions.push_back(top.empty() 
+                ? Prediction{ model->get_labels().get_unknown_id(), log(0) } 
+                : top[0]);
+        }
+        for (const Pruning_stats &stats : chunk_pruning) {
+            pruning.add(stats);
+        }
+        return predictions;
+    }
+
+    // posts per task when tokenizing or scoring posts in parallel
+    static const size_t chunk_size = 256;
+    // how often --follow checks the training file for new rows
+    static constexpr int follow_poll_ms = 1000;
+    // how long --follow sleeps between checks for a signal
+    static constexpr int follow_wait_ms = 50;
+
+    // helper data functions
+    // EFFECTS: Counts the training posts as options ask.
+    Data train(const Options &options, ThreadPool &pool) {
+        Features features;
+        features.hash_bits = options.hash_bits;
+        features.ngram_order = options.ngrams;
+        features.term_counts = options.multinomial;
+        adjust_vector(unadjusted_vector, features, pool);
+        return Data(adjusted_vector, pool, features);
+    }
+
+    // REQUIRES: vec outlives adjusted_vector
+    // EFFECTS: Splits every training post into its unique words and the
+    //          keys of its n-grams of up to features.ngram_order words, or
+    //          into every occurrence of them for term counts, in chunks on
+    //          the threads of pool.
+    void adjust_vector(const vector<pair<string, string>> &vec, 
+                       const Features &features, ThreadPool &pool) {
+        adjusted_vector.resize(vec.size());
+        ngram_keys.resize(vec.size());
+        pool.run((vec.size() + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+            Tokenizer tokenizer;
+            size_t end = min(vec.size(), (chunk + 1) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+                const vector<string_view> &words = tokenizer.get_features(
+                    vec[i].second, features.ngram_order, features.term_counts, 
+                    ngram_keys[i]);
+                adjusted_vector[i].first = vec[i].first;
+                adjusted_vector[i].second.assign(words.begin(), words.end());
+            }
+        });
+    }
+
+    void print_top_predictions(const Model *model, 
+                               const vector<Prediction> &top) {
+        cout << "  top " << top.size() << " =";
+        for (size_t i = 0; i < top.size(); ++i) {
+            cout << (i == 0 ? " " : ", ") 
+                 << model->get_labels().get_string(top[i].label) 
+                 << " (" << top[i].log_probability << ")";
+        }
+        cout << endl;
+    }
+
+    void print_pruning_stats(const Pruning_stats &pruning) {
+        cout << "top-k pruning: added " << pruning.additions << " of " 
+             << pruning.full_additions << " log-likelihoods, abandoned " 
+             << pruning.pruned_labels << " of " << pruning.labels 
+             << " labels" << endl;
+    }
+
+    // EFFECTS: If options ask for n-grams or hashing, prints how many
+    //          features data has and the memory they take: the word
+    //          Vocabulary, the counts, and the tables of a Model built from
+    //          them.
+    void print_features(const Options &options, const Data &data) {
+        if (options.ngrams == 1 && options.hash_bits == 0) {
+            return;
+        }
+        const Vocabulary &words = data.get_words();
+        double word_count = words.size();
+        double label_count = data.get_labels().size();
+        double vocabulary_bytes = 0;
+        if (words.get_hash_bits() > 0) {
+            int used = 0;
+            for (int word = 0; word < words.size(); ++word) {
+                used += data.get_word_frequency(word) > 0;
+            }
+            cout << "features: " << words.size() << " hash buckets, " 
+                 << used << " used" << endl;
+        }
+        else {
+            // the number of features of each length
+            vector<int> counts(options.ngrams + 1, 0);
+            for (int word = 0; word < words.size(); ++word) {
+                string_view feature = words.get_string(word);
+                counts[Tokenizer::is_ngram_key(feature) ? feature[1] - '0' : 1]++;
+            }
+            cout << "features: " << counts[1] << " words";
+            for (int n = 2; n <= options.ngrams; ++n) {
+                cout << ", " << counts[n] << " " << n << "-grams";
+            }
+            cout << endl;
+            vocabulary_bytes = (word_count + 1) * sizeof(uint64_t) 
+                + words.get_offsets()[words.size()] 
+                + words.get_slot_count() * sizeof(uint32_t);
+        }
+        double count_bytes = 
+            (word_count * label_count + word_count + label_count) * sizeof(double);
+        double table_bytes = (word_count + 3) 
+            * Model::get_label_stride(label_count) * sizeof(double);
+        const double mib = 1 << 20;
+        cout << "memory: vocabulary " << vocabulary_bytes / mib 
+             << " MiB, counts " << count_bytes / mib << " MiB, model tables " 
+             << table_bytes / mib << " MiB" << endl;
+    }
+
+    void print_training_data() {
+        cout << "training data:" << endl;
+        for (const auto &post : unadjusted_vector) {
+            cout << "  label = " << post.first << ", content = " << post.second << endl;
+        }
+    }
+
+    void print_training_post_count(const Model *model) {
+        cout << "trained on " << model->get_post_count() << " examples" << endl;
+    }
+
+    void print_vocab_size(Data *data) {
+        cout << "vocabulary size = " << data->get_words().size() << "\n" << endl;
+    }
+
+    void print_classes(Data *data, const Model *model) {
+        cout << "classes:" << endl;
+        const Vocabulary &labels = data->get_labels();
+        for (int label = 0; label < labels.size(); ++label)
+        cout << "  " << labels.get_string(label) << ", " 
+             << data->get_label_frequency(label) 
+             << " examples, log-prior = " << model->get_log_prior(label) << endl;
+    }
+
+    void print_classifier_params(Data *data, const Model *model) {
+        cout << "classifier parameters:" << endl;
+        const Vocabulary &labels = data->get_labels();
+        const Vocabulary &words = data->get_words();
+        for (int label = 0; label < labels.size(); ++label) {
+            for (int word = 0; word < words.size(); ++word) {
+                double count = data->get_label_word_frequency(label, word);
+                if (count > 0) {
+                    cout << "  " << labels.get_string(label) << ":" 
+                         << words.get_string(word) << ", count = " << count 
+                         << ", log-likelihood = " 
+                         << model->get_log_likelihood(label, word) << endl;
+                }
+            }
+        }
+    }
+};
+
+
+// the most hash bits --hash-bits accepts, which keeps the counts of each
+// label under 128 MiB
+const int max_hash_bits = 24;
+// the longest n-grams --ngrams accepts
+const int max_ngram_order = 3;
+
+int main(int argc, char * argv[]) {
+    cout.precision(3);
+    const string usage = 
+        "Usage: main.exe TRAIN_FILE TEST_FILE [--debug] [--threads N] "
+        "[--save-model MODEL_FILE] [--follow] [--top-k K | --sparse] "
+        "[--alpha A] [--hash-bits B] [--ngrams N] [--multinomial] "
+        "[--metrics] [--metrics-csv CSV_FILE]\n"
+        "       main.exe --load-model MODEL_FILE TEST_FILE [--threads N] "
+        "[--top-k K | --sparse] [--metrics] [--metrics-csv CSV_FILE]\n"
+        "       main.exe TRAIN_FILE --serve [--socket PATH] [--threads N] "
+        "[--save-model MODEL_FILE] [--sparse] [--alpha A] [--hash-bits B] "
+        "[--ngrams N] [--multinomial]\n"
+        "       main.exe --load-model MODEL_FILE --serve [--socket PATH] "
+        "[--threads N] [--sparse]\n"
+        "       main.exe TRAIN_FILE --cv K [--threads N] [--sparse] "
+        "[--alpha A] [--hash-bits B] [--ngrams N] [--multinomial] "
+        "[--metrics] [--metrics-csv CSV_FILE]\n"
+        "       main.exe TRAIN_FILE TEST_FILE --sweep alpha=A1,A2,... "
+        "[--threads N] [--hash-bits B] [--ngrams N] [--multinomial]";
+
+    Options options;
+    string train_file_name;
+    string test_file_name;
+    int next_arg = 1;
+    if (argc >= 3 && argv[1] == string("--load-model")) {
+        options.load_model = argv[2];
+        next_arg = 3;
+    }
+    else if (argc >= 2) {
+        train_file_name = argv[1];
+        next_arg = 2;
+    }
+
+    if (next_arg < argc && argv[next_arg] == string("--serve")) {
+        options.serve = true;
+    }
+    else if (next_arg + 1 < argc && argv[next_arg] == string("--cv") 
+             && options.load_model.empty() && atoi(argv[next_arg + 1]) > 1) {
+        // held-out folds come from the training file
+        options.cv = atoi(argv[++next_arg]);
+    }
+    else if (next_arg < argc && argc >= 3) {
+        test_file_name = argv[next_arg];
+    }
+    else { //checks for correct # of arguments
+        cout << usage << endl;
+        return -1;
+    }
+
+    for (int i = next_arg + 1; i < argc; ++i) {
+        string option = argv[i];
+        vector<double> alphas;
+        if (option == "--debug" && options.load_model.empty() && !options.serve 
+            && options.cv == 0) {
+            // a loaded model has no training data to show
+            options.debug = true;
+        }
+        else if (option == "--threads" && i + 1 < argc 
+                 && atoi(argv[i + 1]) > 0) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (option == "--save-model" && i + 1 < argc 
+                 && options.load_model.empty() && options.cv == 0) {
+            options.save_model = argv[++i];
+        }
+        else if (option == "--follow" && options.load_model.empty() 
+                 && !options.serve && options.cv == 0) {
+            // a loaded model has no counts to add to
+            options.follow = true;
+        }
+        else if (option == "--top-k" && i + 1 < argc && !options.serve 
+                 && options.cv == 0 && !options.sparse 
+                 && atoi(argv[i + 1]) > 0) {
+            options.top_k = atoi(argv[++i]);
+        }
+        else if (option == "--sparse" && options.top_k == 0) {
+            options.sparse = true;
+        }
+        else if (option == "--alpha" && i + 1 < argc 
+                 && options.load_model.empty() 
+                 && parse_alphas(argv[i + 1], alphas) && alphas.size() == 1) {
+            // a loaded model keeps the smoothing it was trained with
+            options.alpha = alphas[0];
+            ++i;
+        }
+        else if (option == "--sweep" && i + 1 < argc 
+                 && options.load_model.empty() && !options.serve 
+                 && options.cv == 0 && options.sweep.empty() 
+                 && parse_alphas(argv[i + 1], options.sweep)) {
+            ++i;
+        }
+        else if (option == "--hash-bits" && i + 1 < argc 
+                 && options.load_model.empty() && atoi(argv[i + 1]) > 0 
+                 && atoi(argv[i + 1]) <= max_hash_bits) {
+            // a loaded model keeps the words it was trained with
+            options.hash_bits = atoi(argv[++i]);
+        }
+        else if (option == "--ngrams" && i + 1 < argc 
+                 && options.load_model.empty() && atoi(argv[i + 1]) > 0 
+                 && atoi(argv[i + 1]) <= max_ngram_order) {
+            // a loaded model keeps the features it was trained with
+            options.ngrams = atoi(argv[++i]);
+        }
+        else if (option == "--multinomial" && options.load_model.empty()) {
+            // a loaded model keeps the features it was trained with
+            options.multinomial = true;
+        }
+        else if (option == "--metrics" && !options.serve) {
+            options.metrics = true;
+        }
+        else if (option == "--metrics-csv" && i + 1 < argc && !options.serve) {
+            options.metrics_csv = argv[++i];
+        }
+        else if (option == "--socket" && i + 1 < argc && options.serve) {
+            options.socket = argv[++i];
+        }
+        else {
+            cout << usage << endl;
+            return -1;
+        }
+    }
+
+    // a sweep replaces scoring with a single model, so it takes no other
+    // options but --threads and those that choose the features
+    if (!options.sweep.empty() 
+        && (options.debug || !options.save_model.empty() || options.follow 
+            || options.top_k > 0 || options.sparse || options.alpha != 0 
+            || options.metrics || !options.metrics_csv.empty())) {
+        cout << usage << endl;
+        return -1;
+    }
+    // scoring by term counts has no sparse index or top-k pruning
+    if (options.multinomial && (options.top_k > 0 || options.sparse)) {
+        cout << usage << endl;
+        return -1;
+    }
+    // hash buckets have no words to show, and n-gram keys no readable ones
+    if (options.debug && (options.hash_bits > 0 || options.ngrams > 1)) {
+        cout << usage << endl;
+        return -1;
+    }
+
+    vector<pair<string, string>> train_rows;
+    vector<pair<string, string>> test_rows;
+    
+    Csv_follower follower(train_file_name);
+    if (options.follow) {
+        try {
+            train_rows = follower.read_rows();
+        }
+        catch (const csvstream_exception &e) {
+            cout << "Error opening file: " << train_file_name << endl;
+            return -1;
+        }
+    }
+    else if (options.load_model.empty()) {
+        try {
+            csvstream train_csv(train_file_name);
+            map<string, string> train_row;
+            while (train_csv >> train_row) {
+                //cout << row["tag"] << ": " << row["content"] << endl;
+                pair<string, string> new_row(train_row["tag"], train_row["content"]);
+                train_rows.push_back(new_row);
+            }
+        } 
+        catch (const csvstream_exception &e) {
+            cout << "Error opening file: " << train_file_name << endl;
+            return -1;
+        }
+    }
+
+    if (!options.serve && options.cv == 0) {
+        try {
+            csvstream test_csv(test_file_name);
+            map<string, string> test_row;
+            while (test_csv >> test_row) {
+                pair<string, string> new_row(test_row["tag"], test_row["content"]);
+                test_rows.push_back(new_row);
+            }
+        } 
+        catch (const csvstream_exception &e) {
+            cout << "Error opening file: " << test_file_name << endl;
+            return -1;
+        }
+    }
+
+    try {
+        Classifier classy(train_rows, test_rows, options, &follower);
+    }
+    catch (const model_file_exception &e) {
+        cout << e.what() << endl;
+        return -1;
+    }
+    catch (const csvstream_exception &e) {
+        // the followed training file went away or has a malformed row
+        cout << e.what() << endl;
+        return -1;
+    }
+    catch (const server_exception &e) {
+        cout << e.what() << endl;
+        return -1;
+    }
 }
\ No newline at end of file